@@ -72,7 +72,12 @@ BOARD_USES_ALSA_AUDIO := true
 USE_CUSTOM_AUDIO_POLICY := 1
 
 # Bluetooth
+TARGET_BLUETOOTH_CAPACITY_PROFILE ?= default
+ifeq ($(TARGET_BLUETOOTH_CAPACITY_PROFILE),default)
 BOARD_BLUETOOTH_BDROID_BUILDCFG_INCLUDE_DIR := $(DEVICE_PATH)/bluetooth/include
+else
+BOARD_BLUETOOTH_BDROID_BUILDCFG_INCLUDE_DIR := $(DEVICE_PATH)/bluetooth/capacity/$(TARGET_BLUETOOTH_CAPACITY_PROFILE)
+endif
 BOARD_HAVE_BLUETOOTH_QCOM := true
 TARGET_FWK_SUPPORTS_FULL_VALUEADDS := true
 TARGET_USE_QTI_BT_STACK := true
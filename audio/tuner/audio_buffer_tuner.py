@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Sweep audio HAL period sizes on a loopback and pick the best stable ones.
+
+  audio_buffer_tuner.py [-s SERIAL] [--card N] [--playback D] [--capture D]
+                        [--mixer FILE] [--repeat N] [--seconds S] [--check]
+  audio_buffer_tuner.py --host loopback|dummy [...]
+
+Each candidate is run through audio_latency_probe, which plays a click
+train and measures the round trip and xruns. A configuration is stable
+if every repeat ran without underruns or glitches; the stable one with
+the lowest median round trip wins. Results are printed as a vendor.prop
+fragment per use case.
+
+On a device the audio HAL is stopped for the sweep and the optional
+mixer file (one "tinymix" argument list per line) sets up the loopback
+route. With --host the probe runs against snd-aloop (latency and xruns)
+or snd-dummy (xruns only), so a regression run needs no hardware.
+
+--check exits non-zero if the values shipped in vendor.prop are not
+stable on this setup.
+
+Playback is also swept over the ALSA period count. The audio HAL fixes
+it for the low latency path, so it is not a property: a pick other than
+the HAL's count is reported as a comment.
+
+vendor.audio_hal.period_multiplier (af_period_multiplier) sizes the
+buffer AudioFlinger sees, in periods, not the ALSA period count, and
+vendor.audio.adm.buffering.ms and aaudio.hw_burst_min_usec act inside
+the DSP and AAudio. None of them is exercised by a raw PCM loopback,
+they are reported unchanged.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+PROPS = {
+    'period_size': 'vendor.audio_hal.period_size',
+    'in_period_size': 'vendor.audio_hal.in_period_size',
+}
+PASSTHROUGH_PROPS = ['vendor.audio_hal.period_multiplier', 'vendor.audio.adm.buffering.ms',
+                     'aaudio.hw_burst_min_usec']
+
+# ALSA periods of the audio HAL's low latency playback config.
+HAL_PERIOD_COUNT = 2
+
+# Candidates per use case. Sizes are in frames at 48 kHz and kept to
+# multiples of 48 (1 ms), which the DSP frontends require.
+PLAYBACK_PERIOD_SIZES = [96, 144, 192, 240, 288]
+PLAYBACK_PERIOD_COUNTS = [2, 3, 4]
+CAPTURE_PERIOD_SIZES = [96, 144, 192, 240]
+
+DEVICE_PROBE = '/vendor/bin/audio_latency_probe'
+AUDIO_HAL_SERVICE = 'vendor.audio-hal'
+
+
+class Runner:
+    """Runs the probe locally (host) or over adb (device)."""
+
+    def __init__(self, args):
+        self.args = args
+        self.serial = args.serial
+        self.host = args.host
+        self.card = args.card
+        self.playback = args.playback
+        self.capture = args.capture
+        if self.host:
+            self.card = find_host_card('Loopback' if self.host == 'loopback' else 'Dummy')
+            if self.host == 'loopback':
+                # snd-aloop loops device 0 back into device 1.
+                self.playback, self.capture = 0, 1
+
+    def adb(self, *args):
+        command = ['adb'] + (['-s', self.serial] if self.serial else []) + list(args)
+        return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+
+    def setup(self):
+        if self.host:
+            return
+        self.adb('root')
+        self.adb('wait-for-device')
+        self.adb('shell', 'stop', AUDIO_HAL_SERVICE)
+        if self.args.mixer:
+            with open(self.args.mixer, 'r') as f:
+                for line in f:
+                    line = line.split('#', 1)[0].strip()
+                    if line:
+                        self.adb('shell', 'tinymix -D %d %s' % (self.card, line))
+
+    def teardown(self):
+        if not self.host:
+            self.adb('shell', 'start', AUDIO_HAL_SERVICE)
+
+    def probe(self, config):
+        options = ['-D', str(self.card), '-P', str(self.playback), '-C', str(self.capture),
+                   '-p', str(config['period_size']), '-m', str(config['period_count']),
+                   '-i', str(config['in_period_size']), '-t', str(self.args.seconds)]
+        if self.host == 'dummy':
+            options.append('-n')
+        if self.host:
+            command = [self.args.probe] + options
+        else:
+            command = ['adb'] + (['-s', self.serial] if self.serial else []) + [
+                'shell', DEVICE_PROBE] + options
+        result = subprocess.run(command, capture_output=True, text=True)
+        if result.returncode != 0:
+            return None
+        return parse_probe(result.stdout)
+
+
+def find_host_card(name):
+    try:
+        with open('/proc/asound/cards', 'r') as f:
+            for line in f:
+                match = re.match(r'\s*(\d+)\s+\[(\S+)\s*\]', line)
+                if match and match.group(2) == name:
+                    return int(match.group(1))
+    except OSError:
+        pass
+    module = 'snd-aloop' if name == 'Loopback' else 'snd-dummy'
+    sys.exit('no %s card, load it with "modprobe %s"' % (name, module))
+
+
+def parse_probe(output):
+    values = {}
+    for field in output.split():
+        key, _, value = field.partition('=')
+        values[key] = int(value)
+    return values
+
+
+def load_current(path):
+    current = {}
+    with open(path, 'r') as f:
+        for line in f:
+            key, sep, value = line.strip().partition('=')
+            if sep:
+                current[key] = value
+    return current
+
+
+class Outcome:
+    def __init__(self, config):
+        self.config = config
+        self.runs = []
+
+    @property
+    def stable(self):
+        return bool(self.runs) and all(
+            run is not None and run['underruns'] == 0 and run.get('glitches', 0) == 0
+            and run.get('detected', 1) > 0 for run in self.runs)
+
+    @property
+    def rtt_us(self):
+        values = [run['rtt_us_median'] for run in self.runs if run and 'rtt_us_median' in run]
+        return max(values) if values else None
+
+    def describe(self):
+        underruns = sum(run['underruns'] for run in self.runs if run)
+        glitches = sum(run.get('glitches', 0) for run in self.runs if run)
+        failed = sum(1 for run in self.runs if run is None)
+        rtt = self.rtt_us
+        return '%-5s rtt %8s  underruns %3d  glitches %3d%s' % (
+            'ok' if self.stable else 'FAIL', '%.2fms' % (rtt / 1000) if rtt is not None else '-',
+            underruns, glitches, '  (%d runs failed)' % failed if failed else '')
+
+
+def sweep(runner, configs, repeat):
+    outcomes = []
+    for config in configs:
+        outcome = Outcome(config)
+        for _ in range(repeat):
+            outcome.runs.append(runner.probe(config))
+        print('  period_size=%-4d period_count=%d in_period_size=%-4d %s' % (
+            config['period_size'], config['period_count'], config['in_period_size'],
+            outcome.describe()))
+        outcomes.append(outcome)
+    return outcomes
+
+
+def best(outcomes):
+    """Lowest round trip among stable outcomes; on dummy, the smallest buffer."""
+    stable = [o for o in outcomes if o.stable]
+    if not stable:
+        return None
+
+    def key(outcome):
+        c = outcome.config
+        rtt = outcome.rtt_us
+        return (rtt if rtt is not None else 0, c['period_size'] * c['period_count'],
+                c['in_period_size'])
+    return min(stable, key=key)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-s', '--serial')
+    parser.add_argument('--host', choices=['loopback', 'dummy'])
+    parser.add_argument('--card', type=int, default=0)
+    parser.add_argument('--playback', type=int, default=0)
+    parser.add_argument('--capture', type=int, default=0)
+    parser.add_argument('--mixer')
+    parser.add_argument('--repeat', type=int, default=3)
+    parser.add_argument('--seconds', type=int, default=10)
+    parser.add_argument('--probe', default='audio_latency_probe')
+    parser.add_argument('--props', default=os.path.join(here, '..', '..', 'vendor.prop'))
+    parser.add_argument('--check', action='store_true')
+    args = parser.parse_args()
+
+    current_props = load_current(args.props)
+    current = {name: int(current_props[prop]) for name, prop in PROPS.items()}
+    current['period_count'] = HAL_PERIOD_COUNT
+
+    runner = Runner(args)
+    runner.setup()
+    try:
+        print('current')
+        shipped = sweep(runner, [current], args.repeat)[0]
+        if args.check:
+            return 0 if shipped.stable else 1
+
+        print('playback')
+        playback = best(sweep(runner, [
+            dict(current, period_size=size, period_count=count)
+            for size in PLAYBACK_PERIOD_SIZES for count in PLAYBACK_PERIOD_COUNTS], args.repeat))
+        base = playback.config if playback else current
+
+        print('capture')
+        capture = best(sweep(runner, [
+            dict(base, in_period_size=size) for size in CAPTURE_PERIOD_SIZES], args.repeat))
+    finally:
+        runner.teardown()
+
+    print()
+    for name, outcome, keys in (('low latency playback', playback, ['period_size', 'period_count']),
+                                ('capture', capture, ['in_period_size'])):
+        if outcome is None:
+            print('# %s: no stable configuration' % name)
+            continue
+        rtt = outcome.rtt_us
+        print('# %s%s' % (name, ', round trip %.2f ms' % (rtt / 1000) if rtt is not None else ''))
+        for key in keys:
+            if key in PROPS:
+                print('%s=%d' % (PROPS[key], outcome.config[key]))
+            elif outcome.config[key] != HAL_PERIOD_COUNT:
+                print('# needs %s=%d, the audio HAL uses %d' % (
+                    key, outcome.config[key], HAL_PERIOD_COUNT))
+    for prop in PASSTHROUGH_PROPS:
+        if prop in current_props:
+            print('%s=%s' % (prop, current_props[prop]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Plays a click train on one PCM, records another and reports the
+// round-trip latency and xruns for one period configuration. The
+// playback PCM must be looped back into the capture PCM, either on the
+// device (mixer loopback or a cable) or on a host with snd-aloop. With
+// snd-dummy there is no signal, so pass -n and only xruns are counted.
+//
+// Output is a single key=value line for audio_buffer_tuner.py.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <tinyalsa/asoundlib.h>
+
+namespace {
+
+struct Options {
+    unsigned int card = 0;
+    unsigned int playbackDevice = 0;
+    unsigned int captureDevice = 0;
+    unsigned int rate = 48000;
+    unsigned int channels = 2;
+    unsigned int periodSize = 192;
+    unsigned int periodCount = 3;
+    unsigned int inPeriodSize = 144;
+    unsigned int inPeriodCount = 2;
+    unsigned int seconds = 10;
+    bool noSignal = false;
+};
+
+// One click every 200 ms, longer than any sane round trip so clicks
+// can't be paired with the wrong echo.
+constexpr unsigned int kClickIntervalMs = 200;
+constexpr unsigned int kClickFrames = 8;
+constexpr int16_t kClickLevel = 16384;
+constexpr int16_t kDetectLevel = 8192;
+
+std::atomic<bool> gStop{false};
+
+void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [-D card] [-P playback device] [-C capture device] [-r rate] [-c channels]\n"
+            "          [-p period_size] [-m period_count] [-i in_period_size] [-k in_period_count]\n"
+            "          [-t seconds] [-n]\n",
+            name);
+}
+
+pcm* openPcm(const Options& o, unsigned int device, unsigned int flags, unsigned int periodSize,
+             unsigned int periodCount) {
+    pcm_config config = {};
+    config.channels = o.channels;
+    config.rate = o.rate;
+    config.period_size = periodSize;
+    config.period_count = periodCount;
+    config.format = PCM_FORMAT_S16_LE;
+    config.start_threshold = periodSize;
+    config.stop_threshold = periodSize * periodCount;
+
+    pcm* p = pcm_open(o.card, device, flags, &config);
+    if (!p || !pcm_is_ready(p)) {
+        fprintf(stderr, "cannot open pcm %u,%u: %s\n", o.card, device,
+                p ? pcm_get_error(p) : "out of memory");
+        if (p) pcm_close(p);
+        return nullptr;
+    }
+    return p;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    int opt;
+    while ((opt = getopt(argc, argv, "D:P:C:r:c:p:m:i:k:t:nh")) != -1) {
+        switch (opt) {
+            case 'D': o.card = atoi(optarg); break;
+            case 'P': o.playbackDevice = atoi(optarg); break;
+            case 'C': o.captureDevice = atoi(optarg); break;
+            case 'r': o.rate = atoi(optarg); break;
+            case 'c': o.channels = atoi(optarg); break;
+            case 'p': o.periodSize = atoi(optarg); break;
+            case 'm': o.periodCount = atoi(optarg); break;
+            case 'i': o.inPeriodSize = atoi(optarg); break;
+            case 'k': o.inPeriodCount = atoi(optarg); break;
+            case 't': o.seconds = atoi(optarg); break;
+            case 'n': o.noSignal = true; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (!o.channels || !o.periodSize || o.periodCount < 2 || !o.inPeriodSize ||
+        o.inPeriodCount < 2 || !o.seconds) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    pcm* out = openPcm(o, o.playbackDevice, PCM_OUT | PCM_NORESTART, o.periodSize, o.periodCount);
+    if (!out) return 1;
+    pcm* in = nullptr;
+    if (!o.noSignal) {
+        in = openPcm(o, o.captureDevice, PCM_IN, o.inPeriodSize, o.inPeriodCount);
+        if (!in) {
+            pcm_close(out);
+            return 1;
+        }
+    }
+
+    const uint64_t totalFrames = static_cast<uint64_t>(o.rate) * o.seconds;
+    const uint64_t clickInterval = static_cast<uint64_t>(o.rate) * kClickIntervalMs / 1000;
+
+    // Capture frame index of every echo. Capture runs first; the
+    // playback clicks are placed relative to the capture frame count at
+    // the moment playback starts, which is exact to one capture period.
+    std::vector<uint64_t> detected;
+    std::atomic<uint64_t> captured{0};
+    std::atomic<bool> readerDone{false};
+    uint64_t base = 0;
+    std::thread reader;
+    if (in) {
+        reader = std::thread([&] {
+            std::vector<int16_t> buf(o.inPeriodSize * o.channels);
+            uint64_t frame = 0;
+            uint64_t quietUntil = 0;
+            while (!gStop) {
+                if (pcm_read(in, buf.data(), buf.size() * sizeof(int16_t))) {
+                    if (!gStop) fprintf(stderr, "capture: %s\n", pcm_get_error(in));
+                    break;
+                }
+                for (unsigned int i = 0; i < o.inPeriodSize; i++, frame++) {
+                    if (frame < quietUntil) continue;
+                    for (unsigned int c = 0; c < o.channels; c++) {
+                        if (abs(buf[i * o.channels + c]) >= kDetectLevel) {
+                            detected.push_back(frame);
+                            quietUntil = frame + clickInterval / 2;
+                            break;
+                        }
+                    }
+                }
+                captured = frame;
+            }
+            readerDone = true;
+        });
+        while (!captured && !readerDone) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        base = captured;
+    }
+
+    std::vector<int16_t> buf(o.periodSize * o.channels);
+    unsigned int underruns = 0;
+    unsigned int clicks = 0;
+    for (uint64_t frame = 0; frame < totalFrames; frame += o.periodSize) {
+        std::fill(buf.begin(), buf.end(), 0);
+        for (unsigned int i = 0; i < o.periodSize; i++) {
+            // The last interval stays silent so every echo is back
+            // before capture stops.
+            uint64_t phase = (frame + i) % clickInterval;
+            if (o.noSignal || frame + i + clickInterval >= totalFrames) continue;
+            if (phase == 0) clicks++;
+            if (phase < kClickFrames) {
+                for (unsigned int c = 0; c < o.channels; c++) buf[i * o.channels + c] = kClickLevel;
+            }
+        }
+        if (pcm_write(out, buf.data(), buf.size() * sizeof(int16_t))) {
+            if (errno != EPIPE) {
+                fprintf(stderr, "playback: %s\n", pcm_get_error(out));
+                break;
+            }
+            underruns++;
+            pcm_prepare(out);
+        }
+    }
+
+    if (in) {
+        uint64_t end = base + totalFrames;
+        while (captured < end && !readerDone) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    gStop = true;
+    pcm_close(out);
+    if (reader.joinable()) {
+        // Dropping the capture stream unblocks the last read.
+        pcm_stop(in);
+        reader.join();
+    }
+    if (in) pcm_close(in);
+
+    printf("period_size=%u period_count=%u in_period_size=%u in_period_count=%u underruns=%u",
+           o.periodSize, o.periodCount, o.inPeriodSize, o.inPeriodCount, underruns);
+    if (o.noSignal) {
+        printf("\n");
+        return 0;
+    }
+
+    // Pair the n-th echo with the n-th click. A dropped capture period
+    // or playback underrun shifts the echo, which shows up as jitter.
+    std::vector<uint64_t> rtt;
+    for (size_t n = 0; n < detected.size() && n < clicks; n++) {
+        uint64_t sent = base + n * clickInterval;
+        if (detected[n] >= sent) rtt.push_back(detected[n] - sent);
+    }
+    unsigned int glitches = clicks - rtt.size();
+    if (!rtt.empty()) {
+        std::vector<uint64_t> sorted = rtt;
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t median = sorted[sorted.size() / 2];
+        for (uint64_t r : rtt) {
+            if (r > median + o.periodSize || r + o.periodSize < median) glitches++;
+        }
+        auto us = [&](uint64_t frames) { return frames * 1000000 / o.rate; };
+        printf(" clicks=%u detected=%zu rtt_us_min=%llu rtt_us_median=%llu rtt_us_max=%llu", clicks,
+               rtt.size(), (unsigned long long)us(sorted.front()), (unsigned long long)us(median),
+               (unsigned long long)us(sorted.back()));
+    } else {
+        printf(" clicks=%u detected=0", clicks);
+    }
+    printf(" glitches=%u\n", glitches);
+    return 0;
+}
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Resolve and check the A2DP offload codec lists.
+
+  a2dp_offload_cap.py check [--werror] PROP...
+  a2dp_offload_cap.py resolve -o OUT PROP...
+  a2dp_offload_cap.py probe [-s SERIAL] [--interval SEC] [--count N]
+
+The offload codec set is declared three times: once for the QTI stack,
+once for the QTI audio/BT HAL and once for the AOSP stack. A codec is
+only offloaded if the active stack and the HAL both list it; anything
+else is encoded on the CPU. check fails if the lists disagree, resolve
+also writes the effective set, and probe watches a device while it plays
+and reports whether each negotiated codec really ran offloaded.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+import time
+
+QTI_CODECS = ['sbc', 'aac', 'aptx', 'aptxhd', 'ldac', 'aptxadaptive', 'aptxtws']
+AOSP_CODECS = ['sbc', 'aac', 'aptx', 'aptxhd', 'ldac']
+
+QTI_STACK_CAP = 'persist.vendor.btstack.a2dp_offload_cap'
+QTI_HAL_CAP = 'persist.vendor.qcom.bluetooth.a2dp_offload_cap'
+AOSP_STACK_CAP = 'persist.bluetooth.a2dp_offload.cap'
+
+# Properties that must hold for split A2DP offload to be used at all.
+ENABLE_PROPS = {
+    'ro.bluetooth.a2dp_offload.supported': 'true',
+    'persist.bluetooth.a2dp_offload.disabled': 'false',
+    'persist.vendor.btstack.enable.splita2dp': 'true',
+    'persist.vendor.qcom.bluetooth.enable.splita2dp': 'true',
+    'vendor.audio.feature.a2dp_offload.enable': 'true',
+}
+
+QTI_STACK_LIBRARY = 'libbluetooth_qti.so'
+
+# Effective set resolved at build time, see the a2dp_offload_codecs module.
+SHIPPED_CODECS = '/vendor/etc/bluetooth/a2dp_offload_codecs'
+
+# bluetooth_manager dump: A2dpCodecs::debug_codec_dump() and
+# btif_a2dp_source_debug_dump().
+CURRENT_CODEC_RE = re.compile(r'Current Codec:\s*(\S+)')
+SOURCE_COUNTS_RE = re.compile(r'Counts \(enqueue/dequeue/readbuf\)\s*:\s*(\d+)\s*/\s*(\d+)\s*/\s*(\d+)')
+
+# Codec names as printed by the stack, mapped to offload cap tokens.
+DUMP_CODEC_NAMES = {
+    'SBC': 'sbc',
+    'AAC': 'aac',
+    'aptX': 'aptx',
+    'aptX-HD': 'aptxhd',
+    'aptX-adaptive': 'aptxadaptive',
+    'aptX-TWS': 'aptxtws',
+    'LDAC': 'ldac',
+}
+
+
+def load_props(paths):
+    """Returns {key: (value, 'file:line')}; later files override earlier ones."""
+    props = {}
+    for path in paths:
+        with open(path, 'r') as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line or line.startswith('#') or '=' not in line:
+                    continue
+                key, value = line.split('=', 1)
+                props[key.strip()] = (value.strip(), '%s:%d' % (path, lineno))
+    return props
+
+
+def parse_cap(value):
+    return [token for token in value.split('-') if token]
+
+
+class Result:
+    def __init__(self):
+        self.errors = []
+        self.warnings = []
+        self.effective = []
+
+
+def resolve(props):
+    """Computes the effective offload codec list and checks the others against it."""
+    result = Result()
+
+    def where(key):
+        return props[key][1] if key in props else key
+
+    lists = {}
+    for key, vocabulary in ((QTI_STACK_CAP, QTI_CODECS), (QTI_HAL_CAP, QTI_CODECS),
+                            (AOSP_STACK_CAP, AOSP_CODECS)):
+        if key not in props:
+            result.errors.append('%s is not set' % key)
+            lists[key] = []
+            continue
+        codecs = parse_cap(props[key][0])
+        for codec in sorted(set(c for c in codecs if codecs.count(c) > 1)):
+            result.errors.append('%s: %s lists %s twice' % (where(key), key, codec))
+        for codec in codecs:
+            if codec not in vocabulary:
+                result.errors.append('%s: %s: %s is not a codec this consumer knows' %
+                                     (where(key), key, codec))
+        lists[key] = codecs
+
+    for key, expected in ENABLE_PROPS.items():
+        value = props.get(key, (None,))[0]
+        if value != expected:
+            result.errors.append('%s: %s=%s, offload needs %s' % (where(key), key, value, expected))
+
+    library = props.get('ro.bluetooth.library_name', ('',))[0]
+    stack_key = QTI_STACK_CAP if library == QTI_STACK_LIBRARY else AOSP_STACK_CAP
+    stack, hal = lists[stack_key], lists[QTI_HAL_CAP]
+
+    for codec in stack:
+        if codec not in hal:
+            result.errors.append('%s: %s offloads %s but %s does not, it will be encoded on the CPU' %
+                                 (where(stack_key), stack_key, codec, QTI_HAL_CAP))
+    for codec in hal:
+        if codec not in stack:
+            result.errors.append('%s: %s supports %s but the active stack (%s) does not offload it' %
+                                 (where(QTI_HAL_CAP), QTI_HAL_CAP, codec, stack_key))
+    result.effective = [codec for codec in stack if codec in hal]
+
+    if stack_key == QTI_STACK_CAP:
+        if [c for c in stack if c in hal] != [c for c in hal if c in stack]:
+            result.warnings.append('%s and %s list the codecs in a different order' %
+                                   (QTI_STACK_CAP, QTI_HAL_CAP))
+        # The AOSP list is only read by the AOSP stack, but keep it in sync
+        # for the codecs that stack knows so switching stacks is harmless.
+        aosp = lists[AOSP_STACK_CAP]
+        wanted = [c for c in result.effective if c in AOSP_CODECS]
+        if sorted(aosp) != sorted(wanted):
+            result.errors.append('%s: %s=%s, expected the AOSP codecs of the effective set: %s' %
+                                 (where(AOSP_STACK_CAP), AOSP_STACK_CAP, '-'.join(aosp),
+                                  '-'.join(wanted)))
+    return result
+
+
+def report(result):
+    for message in result.warnings:
+        print('warning: ' + message, file=sys.stderr)
+    for message in result.errors:
+        print('error: ' + message, file=sys.stderr)
+
+
+def parse_source_dump(text):
+    """Returns (codec token or None, readbuf count or None) from a bluetooth_manager dump."""
+    codec = None
+    match = CURRENT_CODEC_RE.search(text)
+    if match:
+        codec = DUMP_CODEC_NAMES.get(match.group(1), match.group(1).lower())
+    counts = SOURCE_COUNTS_RE.search(text)
+    return codec, int(counts.group(3)) if counts else None
+
+
+def adb(serial, *args):
+    command = ['adb'] + (['-s', serial] if serial else []) + list(args)
+    return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+
+
+def probe(serial, interval, count):
+    """Samples the A2DP source while audio plays and reports each codec seen.
+
+    In split A2DP the DSP encodes and the stack's software source path
+    never reads PCM, so its readbuf counter stays flat. If it moves, the
+    codec is being encoded on the CPU.
+    """
+    props = {}
+    for line in adb(serial, 'shell', 'getprop').splitlines():
+        match = re.match(r'\[(.*)\]: \[(.*)\]', line)
+        if match:
+            props[match.group(1)] = (match.group(2), 'device')
+    result = resolve(props)
+    report(result)
+    print('effective offload set: %s' % ('-'.join(result.effective) or '(none)'))
+    shipped = adb(serial, 'shell', 'cat', SHIPPED_CODECS).strip()
+    if shipped != '-'.join(result.effective):
+        print('warning: built with %s, persist overrides changed it' % shipped, file=sys.stderr)
+
+    seen = {}
+    _, last = parse_source_dump(adb(serial, 'shell', 'dumpsys', 'bluetooth_manager'))
+    for _ in range(count):
+        time.sleep(interval)
+        codec, readbuf = parse_source_dump(adb(serial, 'shell', 'dumpsys', 'bluetooth_manager'))
+        if codec is None or readbuf is None or last is None:
+            last = readbuf
+            continue
+        offloaded = readbuf == last
+        last = readbuf
+        if seen.get(codec) == offloaded:
+            continue
+        seen[codec] = offloaded
+        expected = codec in result.effective
+        print('%-14s %-9s expected %-9s%s' % (
+            codec, 'offload' if offloaded else 'software', 'offload' if expected else 'software',
+            '' if offloaded == expected else '  MISMATCH'))
+    return 1 if any(offloaded != (codec in result.effective) for codec, offloaded in seen.items()) else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    check_parser = sub.add_parser('check')
+    check_parser.add_argument('--werror', action='store_true')
+    check_parser.add_argument('props', nargs='+')
+
+    resolve_parser = sub.add_parser('resolve')
+    resolve_parser.add_argument('-o', '--output', required=True)
+    resolve_parser.add_argument('props', nargs='+')
+
+    probe_parser = sub.add_parser('probe')
+    probe_parser.add_argument('-s', '--serial')
+    probe_parser.add_argument('--interval', type=float, default=2.0)
+    probe_parser.add_argument('--count', type=int, default=30)
+
+    args = parser.parse_args()
+
+    if args.command == 'probe':
+        return probe(args.serial, args.interval, args.count)
+
+    result = resolve(load_props(args.props))
+    report(result)
+    if result.errors or (args.command == 'check' and args.werror and result.warnings):
+        return 1
+    if args.command == 'resolve':
+        with open(args.output, 'w') as f:
+            f.write('-'.join(result.effective) + '\n')
+    else:
+        print('-'.join(result.effective))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
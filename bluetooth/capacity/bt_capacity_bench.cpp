@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Host benchmark for the bdroid_capacity.h profiles.
+//
+// For each profile it prints the number of static table slots and the
+// cost of the linear lookups the stack does on those tables for every
+// HCI event or packet: btm_bda_to_acl() and l2cu_find_lcb_by_bd_addr()
+// over MAX_ACL_CONNECTIONS, gatt_find_tcb_by_addr() over
+// GATT_MAX_PHY_CHANNEL and avdt_ad_tc_tbl_by_lcid() over
+// AVDT_NUM_SEPS + AVDT_NUM_LINKS. Tables are modelled with entries of
+// roughly the arm64 size of the real control blocks, so the scans touch
+// the same number of cache lines; the actual static footprint of a
+// built libbluetooth is reported by bt_capacity_footprint.py.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Capacity {
+    const char* name;
+    int acl;
+    int l2cap;
+    int gatt;
+    int seps;
+};
+
+#undef _BDROID_CAPACITY_H
+#include "../include/bdroid_capacity.h"
+constexpr Capacity kDefault = {BDROID_CAPACITY_PROFILE, MAX_ACL_CONNECTIONS, MAX_L2CAP_CHANNELS,
+                               GATT_MAX_PHY_CHANNEL, AVDT_NUM_SEPS};
+#undef _BDROID_CAPACITY_H
+#undef BDROID_CAPACITY_PROFILE
+#undef MAX_ACL_CONNECTIONS
+#undef MAX_L2CAP_CHANNELS
+#undef GATT_MAX_PHY_CHANNEL
+#undef AVDT_NUM_SEPS
+
+#include "wearable/bdroid_capacity.h"
+constexpr Capacity kWearable = {BDROID_CAPACITY_PROFILE, MAX_ACL_CONNECTIONS, MAX_L2CAP_CHANNELS,
+                                GATT_MAX_PHY_CHANNEL, AVDT_NUM_SEPS};
+#undef _BDROID_CAPACITY_H
+#undef BDROID_CAPACITY_PROFILE
+#undef MAX_ACL_CONNECTIONS
+#undef MAX_L2CAP_CHANNELS
+#undef GATT_MAX_PHY_CHANNEL
+#undef AVDT_NUM_SEPS
+
+#include "minimal/bdroid_capacity.h"
+constexpr Capacity kMinimal = {BDROID_CAPACITY_PROFILE, MAX_ACL_CONNECTIONS, MAX_L2CAP_CHANNELS,
+                               GATT_MAX_PHY_CHANNEL, AVDT_NUM_SEPS};
+
+constexpr Capacity kProfiles[] = {kDefault, kWearable, kMinimal};
+
+// Stack default, bt_target.h
+constexpr int kAvdtNumLinks = 2;
+
+// Approximate arm64 sizeof() of tACL_CONN, tL2C_LCB, tGATT_TCB and
+// tAVDT_AD_TC_TBL. Only the stride matters for the scans below.
+constexpr size_t kAclEntrySize = 320;
+constexpr size_t kLcbEntrySize = 448;
+constexpr size_t kTcbEntrySize = 512;
+constexpr size_t kTcTblEntrySize = 16;
+
+struct Addr {
+    uint8_t b[6];
+    bool operator==(const Addr& o) const { return memcmp(b, o.b, sizeof(b)) == 0; }
+};
+
+// Common head of the modelled control blocks: in_use flag plus the key
+// the stack compares on. The rest of the entry is padding.
+struct Head {
+    bool in_use;
+    uint8_t transport;
+    uint16_t lcid;
+    Addr addr;
+};
+
+class Table {
+  public:
+    Table(int slots, size_t stride) : slots_(slots), stride_(stride), mem_(slots * stride) {}
+
+    Head& at(int i) { return *reinterpret_cast<Head*>(&mem_[i * stride_]); }
+
+    // btm_bda_to_acl(), l2cu_find_lcb_by_bd_addr(), gatt_find_tcb_by_addr()
+    int findByAddr(const Addr& addr, uint8_t transport) {
+        for (int i = 0; i < slots_; i++) {
+            const Head& h = at(i);
+            if (h.in_use && h.addr == addr && h.transport == transport) return i;
+        }
+        return -1;
+    }
+
+    // avdt_ad_tc_tbl_by_lcid()
+    int findByLcid(uint16_t lcid) {
+        for (int i = 0; i < slots_; i++) {
+            const Head& h = at(i);
+            if (h.in_use && h.lcid == lcid) return i;
+        }
+        return -1;
+    }
+
+    size_t bytes() const { return mem_.size(); }
+
+  private:
+    int slots_;
+    size_t stride_;
+    std::vector<uint8_t> mem_;
+};
+
+Addr makeAddr(int n) {
+    return Addr{{0x00, 0x1a, 0x7d, 0xda, static_cast<uint8_t>(n >> 8), static_cast<uint8_t>(n)}};
+}
+
+// Marks the first |connected| slots in use, as the stack's first-free
+// allocation does.
+void populate(Table& table, int connected) {
+    for (int i = 0; i < connected; i++) {
+        Head& h = table.at(i);
+        h.in_use = true;
+        h.transport = 1;
+        h.lcid = 0x40 + i;
+        h.addr = makeAddr(i);
+    }
+}
+
+template <typename F>
+double nsPerOp(long iterations, F&& op) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) op(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+volatile int sink;
+
+void benchAddrTable(const char* label, int slots, size_t stride, int connected, long iterations) {
+    Table table(slots, stride);
+    populate(table, connected);
+    // The last connected peer is the worst hit; an unknown address (scan
+    // results, stale handles) walks the whole table.
+    Addr hit = makeAddr(connected - 1);
+    Addr miss = makeAddr(0xffff);
+    double hitNs = nsPerOp(iterations, [&](long) { sink = table.findByAddr(hit, 1); });
+    double missNs = nsPerOp(iterations, [&](long) { sink = table.findByAddr(miss, 1); });
+    printf("  %-10s %3d slots %7zu bytes   hit %6.1f ns   miss %6.1f ns\n", label, slots,
+           table.bytes(), hitNs, missNs);
+}
+
+void benchLcidTable(const char* label, int slots, size_t stride, int connected, long iterations) {
+    Table table(slots, stride);
+    populate(table, connected);
+    uint16_t hit = 0x40 + connected - 1;
+    double hitNs = nsPerOp(iterations, [&](long) { sink = table.findByLcid(hit); });
+    double missNs = nsPerOp(iterations, [&](long) { sink = table.findByLcid(0xffff); });
+    printf("  %-10s %3d slots %7zu bytes   hit %6.1f ns   miss %6.1f ns\n", label, slots,
+           table.bytes(), hitNs, missNs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    // bt_capacity_bench [connected peers] [iterations]
+    int connected = argc > 1 ? atoi(argv[1]) : 1;
+    long iterations = argc > 2 ? atol(argv[2]) : 10000000;
+    if (connected < 1 || iterations < 1) {
+        fprintf(stderr, "usage: %s [connected peers >= 1] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    for (const Capacity& c : kProfiles) {
+        printf("%s: MAX_ACL_CONNECTIONS=%d MAX_L2CAP_CHANNELS=%d GATT_MAX_PHY_CHANNEL=%d "
+               "AVDT_NUM_SEPS=%d\n",
+               c.name, c.acl, c.l2cap, c.gatt, c.seps);
+        int peers = connected < c.gatt ? connected : c.gatt;
+        if (peers < connected) {
+            printf("  (only %d of %d peers fit)\n", peers, connected);
+        }
+        benchAddrTable("acl_db", c.acl, kAclEntrySize, peers, iterations);
+        benchAddrTable("lcb_pool", c.acl, kLcbEntrySize, peers, iterations);
+        benchAddrTable("gatt tcb", c.gatt, kTcbEntrySize, peers, iterations);
+        benchLcidTable("avdt tc", c.seps + kAvdtNumLinks, kTcTblEntrySize, 1, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Report the static footprint of libbluetooth builds.
+
+  bt_capacity_footprint.py [--nm NM] LIB [LIB...]
+
+Build the stack once per TARGET_BLUETOOTH_CAPACITY_PROFILE and pass the
+unstripped libbluetooth.so of each (out/target/product/*/symbols/...).
+Prints the size of the control blocks that embed the capacity-sized
+tables, and the total .data/.bss, side by side.
+"""
+
+import argparse
+import subprocess
+import sys
+
+CONTROL_BLOCKS = [
+    'btm_cb',
+    'l2cb',
+    'gatt_cb',
+    'avdt_cb',
+    'bta_gattc_cb',
+    'bta_gatts_cb',
+    'bta_av_cb',
+]
+
+
+def symbol_sizes(nm, lib):
+    """Returns ({symbol: size}, data_bss_total) of the data objects in lib."""
+    out = subprocess.run([nm, '-S', '--defined-only', lib], check=True,
+                         capture_output=True, text=True).stdout
+    sizes = {}
+    total = 0
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) != 4 or fields[2] not in 'bBdD':
+            continue
+        size = int(fields[1], 16)
+        sizes[fields[3]] = size
+        total += size
+    return sizes, total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--nm', default='llvm-nm')
+    parser.add_argument('libs', nargs='+')
+    args = parser.parse_args()
+
+    results = []
+    for lib in args.libs:
+        try:
+            results.append(symbol_sizes(args.nm, lib))
+        except (OSError, subprocess.CalledProcessError) as e:
+            sys.exit('%s: %s' % (lib, e))
+
+    width = max(len(name) for name in CONTROL_BLOCKS + ['.data+.bss'])
+    for index, lib in enumerate(args.libs):
+        print('[%d] %s' % (index, lib))
+    print('%-*s %s' % (width, '', ' '.join('%12s' % ('[%d]' % i) for i in range(len(args.libs)))))
+    for name in CONTROL_BLOCKS:
+        print('%-*s %s' % (width, name,
+                           ' '.join('%12s' % sizes.get(name, '-') for sizes, _ in results)))
+    print('%-*s %s' % (width, '.data+.bss', ' '.join('%12d' % total for _, total in results)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
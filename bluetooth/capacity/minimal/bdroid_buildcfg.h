@@ -0,0 +1,8 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bdroid_capacity.h"
+#include "../../include/bdroid_buildcfg.h"
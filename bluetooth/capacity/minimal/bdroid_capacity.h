@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Minimal-memory profile: a headset plus a couple of LE peers. The ACL
+ * and GATT limits go back to the AOSP defaults. AVDT_NUM_SEPS still has
+ * to cover a source and a sink SEP for every codec in the offload
+ * capability list, otherwise codec registration fails.
+ */
+
+#ifndef _BDROID_CAPACITY_H
+#define _BDROID_CAPACITY_H
+
+#define BDROID_CAPACITY_PROFILE "minimal"
+
+#define MAX_ACL_CONNECTIONS   7
+#define MAX_L2CAP_CHANNELS    16
+#define GATT_MAX_PHY_CHANNEL  7
+#define AVDT_NUM_SEPS 16
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Wearable-heavy profile: many concurrent LE peers (watch, bands, tags,
+ * earbuds), each holding a GATT link and a few L2CAP channels.
+ */
+
+#ifndef _BDROID_CAPACITY_H
+#define _BDROID_CAPACITY_H
+
+#define BDROID_CAPACITY_PROFILE "wearable"
+
+#define MAX_ACL_CONNECTIONS   16
+#define MAX_L2CAP_CHANNELS    48
+#define GATT_MAX_PHY_CHANNEL  16
+#define AVDT_NUM_SEPS 35
+
+#endif
@@ -64,11 +64,10 @@ static inline const char* BtmGetDefaultName() {
 
 #define BTM_DEF_LOCAL_NAME BtmGetDefaultName()
 // Disables read remote device feature
-#define MAX_ACL_CONNECTIONS   16
-#define MAX_L2CAP_CHANNELS    32
 #define BTM_WBS_INCLUDED   TRUE
 #define BTIF_HF_WBS_PREFERRED   TRUE
 #define BLE_VND_INCLUDED   TRUE
-#define GATT_MAX_PHY_CHANNEL  10
-#define AVDT_NUM_SEPS 35
+
+// Static table sizes, see bdroid_capacity.h
+#include "bdroid_capacity.h"
 #endif
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Default capacity profile. These size the stack's static connection
+ * tables (btm_cb.acl_db, l2cb.lcb_pool/ccb_pool, gatt_cb.tcb,
+ * avdt_cb.ccb[].scb), so they cost memory and scan time whether or not
+ * the peers are connected.
+ *
+ * Other profiles live in ../capacity/<profile>/ and are picked with
+ * TARGET_BLUETOOTH_CAPACITY_PROFILE. They share this include guard, so
+ * whichever bdroid_capacity.h is included first wins.
+ */
+
+#ifndef _BDROID_CAPACITY_H
+#define _BDROID_CAPACITY_H
+
+#define BDROID_CAPACITY_PROFILE "default"
+
+#define MAX_ACL_CONNECTIONS   16
+#define MAX_L2CAP_CHANNELS    32
+#define GATT_MAX_PHY_CHANNEL  10
+#define AVDT_NUM_SEPS 35
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.bootboost"
+
+#include "BootBoost.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <sstream>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+
+using android::base::ParseInt;
+using android::base::ReadFileToString;
+using android::base::StartsWith;
+using android::base::StringPrintf;
+using android::base::Trim;
+using android::base::WriteStringToFile;
+
+namespace vendor {
+namespace bootboost {
+
+namespace {
+
+// time_in_state counts in USER_HZ ticks.
+constexpr int64_t kMsPerTick = 10;
+
+}  // namespace
+
+const char Nodes::kSchedBoost[] = "proc/sys/kernel/sched_boost";
+const char Nodes::kCpufreq[] = "sys/devices/system/cpu/cpufreq";
+
+Nodes::Nodes(std::string root) : mRoot(std::move(root)) {
+    if (mRoot.empty() || mRoot.back() != '/') mRoot += '/';
+}
+
+std::string Nodes::path(const std::string& node) const {
+    return mRoot + node;
+}
+
+bool Nodes::readBoost(int* value) const {
+    std::string content;
+    if (!ReadFileToString(path(kSchedBoost), &content)) {
+        PLOG(ERROR) << "Failed to read " << path(kSchedBoost);
+        return false;
+    }
+    return ParseInt(Trim(content), value);
+}
+
+bool Nodes::writeBoost(int value) const {
+    if (!WriteStringToFile(std::to_string(value), path(kSchedBoost))) {
+        PLOG(ERROR) << "Failed to write " << value << " to " << path(kSchedBoost);
+        return false;
+    }
+    return true;
+}
+
+TimeInState Nodes::readTimeInState() const {
+    TimeInState result;
+    DIR* dir = opendir(path(kCpufreq).c_str());
+    if (dir == nullptr) return result;
+    while (dirent* entry = readdir(dir)) {
+        std::string policy = entry->d_name;
+        if (!StartsWith(policy, "policy")) continue;
+        std::string content;
+        if (!ReadFileToString(path(kCpufreq) + "/" + policy + "/stats/time_in_state", &content)) {
+            continue;
+        }
+        std::istringstream lines(content);
+        uint32_t freq;
+        int64_t ticks;
+        auto& times = result[policy];
+        while (lines >> freq >> ticks) times[freq] = ticks * kMsPerTick;
+    }
+    closedir(dir);
+    return result;
+}
+
+BootBoost::BootBoost(Params params, const Nodes& nodes) : mParams(params), mNodes(nodes) {}
+
+bool BootBoost::take(int64_t ms) {
+    mStart = mNodes.readTimeInState();
+    if (!mNodes.writeBoost(1)) return false;
+    mTaken = ms;
+    LOG(INFO) << "sched_boost taken at " << ms << "ms";
+    return true;
+}
+
+void BootBoost::onBootCompleted(int64_t ms) {
+    if (mBootCompleted < 0) mBootCompleted = ms;
+}
+
+int64_t BootBoost::releaseAt() const {
+    int64_t timeout = mTaken + mParams.timeoutMs;
+    if (mBootCompleted < 0) return timeout;
+    return std::min(timeout, mBootCompleted + mParams.settleMs);
+}
+
+bool BootBoost::poll(int64_t ms) {
+    if (mTaken >= 0 && !released() && ms >= releaseAt()) release(ms);
+    return released();
+}
+
+void BootBoost::release(int64_t ms) {
+    mReleased = ms;
+    mEnd = mNodes.readTimeInState();
+    int value;
+    if (mNodes.readBoost(&value) && value != 1) {
+        // Not ours anymore, whoever wrote it owns it now.
+        mForeignValue = value;
+        LOG(WARNING) << "sched_boost is " << value << ", leaving it alone";
+        return;
+    }
+    mNodes.writeBoost(0);
+}
+
+void BootBoost::writeReport(std::ostream& out) const {
+    if (mTaken < 0) {
+        out << "sched_boost was never taken\n";
+        return;
+    }
+    if (!released()) {
+        out << StringPrintf("sched_boost held since %" PRId64 "ms\n", mTaken);
+        return;
+    }
+    out << StringPrintf("sched_boost held %" PRId64 "ms, taken at %" PRId64
+                        "ms, released at %" PRId64 "ms: ",
+                        mReleased - mTaken, mTaken, mReleased);
+    if (mBootCompleted >= 0 && mReleased < mTaken + mParams.timeoutMs) {
+        out << StringPrintf("boot completed at %" PRId64 "ms plus %" PRId64 "ms settle\n",
+                            mBootCompleted, mParams.settleMs);
+    } else {
+        out << StringPrintf("boot did not complete within the %" PRId64 "ms timeout\n",
+                            mParams.timeoutMs);
+    }
+    if (mForeignValue >= 0) {
+        out << StringPrintf("sched_boost was changed to %d meanwhile and left alone\n",
+                            mForeignValue);
+    }
+
+    for (const auto& [policy, end] : mEnd) {
+        auto start = mStart.find(policy);
+        std::map<uint32_t, int64_t> delta;
+        int64_t total = 0;
+        for (const auto& [freq, ms] : end) {
+            int64_t before = 0;
+            if (start != mStart.end()) {
+                auto it = start->second.find(freq);
+                if (it != start->second.end()) before = it->second;
+            }
+            if (ms > before) {
+                delta[freq] = ms - before;
+                total += ms - before;
+            }
+        }
+        out << StringPrintf("%s %" PRId64 "ms\n", policy.c_str(), total);
+        for (const auto& [freq, ms] : delta) {
+            out << StringPrintf("  %8ukHz %8" PRId64 "ms %5.1f%%\n", freq, ms, 100.0 * ms / total);
+        }
+    }
+}
+
+}  // namespace bootboost
+}  // namespace vendor
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace vendor {
+namespace bootboost {
+
+// Time in ms at each frequency in kHz, per cpufreq policy.
+using TimeInState = std::map<std::string, std::map<uint32_t, int64_t>>;
+
+// /proc/sys/kernel/sched_boost and the cpufreq stats, under a root
+// directory so a fake tree can stand in for them.
+class Nodes {
+  public:
+    explicit Nodes(std::string root = "/");
+
+    bool readBoost(int* value) const;
+    bool writeBoost(int value) const;
+    // Policies without stats are left out.
+    TimeInState readTimeInState() const;
+
+    std::string path(const std::string& node) const;
+
+    static const char kSchedBoost[];
+    static const char kCpufreq[];
+
+  private:
+    std::string mRoot;
+};
+
+struct Params {
+    // How long to stay boosted after boot completed, for the burst of
+    // work apps and services start right after it.
+    int64_t settleMs = 10000;
+    // Release even if boot never completes, counted from taking it.
+    int64_t timeoutMs = 120000;
+};
+
+// Holds the scheduler boost for the boot. Takes it when started, then
+// releases it once boot completed and settled, or at the hard timeout.
+// Callers feed it timestamps; it never reads the clock itself.
+class BootBoost {
+  public:
+    BootBoost(Params params, const Nodes& nodes);
+
+    // Writes sched_boost 1 and snapshots the cpufreq stats.
+    bool take(int64_t ms);
+    void onBootCompleted(int64_t ms);
+
+    // When the boost is due to be released.
+    int64_t releaseAt() const;
+    // Releases the boost if it is due. Returns true once released.
+    bool poll(int64_t ms);
+    bool released() const { return mReleased >= 0; }
+
+    // How long the boost was held, why it was released and the time
+    // each policy spent at each frequency meanwhile.
+    void writeReport(std::ostream& out) const;
+
+  private:
+    void release(int64_t ms);
+
+    Params mParams;
+    const Nodes& mNodes;
+    int64_t mTaken = -1;
+    int64_t mBootCompleted = -1;
+    int64_t mReleased = -1;
+    // Someone else changed sched_boost while it was held, it is left
+    // alone then.
+    int mForeignValue = -1;
+    TimeInState mStart;
+    TimeInState mEnd;
+};
+
+}  // namespace bootboost
+}  // namespace vendor
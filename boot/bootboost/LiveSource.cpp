@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.bootboost"
+
+#include "LiveSource.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <android-base/logging.h>
+#include <android-base/properties.h>
+
+using android::base::SetProperty;
+using android::base::WaitForProperty;
+
+namespace vendor {
+namespace bootboost {
+
+namespace {
+
+// sys.boot_completed is not readable from vendor, init mirrors it.
+constexpr char kBootCompleted[] = "vendor.bootboost.boot_completed";
+// held while the boost is ours, init releases it should we die then.
+constexpr char kState[] = "vendor.bootboost.state";
+
+int64_t NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+}  // namespace
+
+bool RunLive(BootBoost& boost) {
+    if (!boost.take(NowMs())) return false;
+    SetProperty(kState, "held");
+
+    bool completed = false;
+    while (!boost.poll(NowMs())) {
+        auto wait = std::chrono::milliseconds(std::max<int64_t>(boost.releaseAt() - NowMs(), 0));
+        if (completed) {
+            std::this_thread::sleep_for(wait);
+        } else if (WaitForProperty(kBootCompleted, "1", wait)) {
+            completed = true;
+            boost.onBootCompleted(NowMs());
+        }
+    }
+    SetProperty(kState, "released");
+    return true;
+}
+
+}  // namespace bootboost
+}  // namespace vendor
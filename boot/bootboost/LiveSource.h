@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "BootBoost.h"
+
+namespace vendor {
+namespace bootboost {
+
+// Takes the boost, waits for boot to complete, as mirrored by init, and
+// releases the boost when it is due.
+bool RunLive(BootBoost& boost);
+
+}  // namespace bootboost
+}  // namespace vendor
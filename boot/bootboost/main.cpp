@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.bootboost"
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+
+#include "BootBoost.h"
+#ifdef __ANDROID__
+#include "LiveSource.h"
+#endif
+
+using android::base::Dirname;
+using android::base::ParseInt;
+using android::base::ReadFileToString;
+using android::base::Split;
+using android::base::WriteStringToFile;
+using vendor::bootboost::BootBoost;
+using vendor::bootboost::Nodes;
+using vendor::bootboost::Params;
+
+namespace {
+
+bool MakeDirs(const std::string& dir) {
+    if (dir == "/" || dir == "." || access(dir.c_str(), F_OK) == 0) return true;
+    return MakeDirs(Dirname(dir)) && (mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST);
+}
+
+bool WriteNode(const Nodes& nodes, const std::string& node, const std::string& content) {
+    std::string path = nodes.path(node);
+    if (!MakeDirs(Dirname(path)) || !WriteStringToFile(content, path)) {
+        PLOG(ERROR) << "Failed to write " << path;
+        return false;
+    }
+    return true;
+}
+
+// Adds "<kHz>:<ms>" pairs to a policy's fake time_in_state.
+bool AddTimeInState(const Nodes& nodes, const std::string& policy, std::istream& pairs) {
+    std::string node = std::string(Nodes::kCpufreq) + "/" + policy + "/stats/time_in_state";
+    std::map<uint32_t, int64_t> ticks;
+    std::string content;
+    if (ReadFileToString(nodes.path(node), &content)) {
+        std::istringstream lines(content);
+        uint32_t freq;
+        int64_t count;
+        while (lines >> freq >> count) ticks[freq] = count;
+    }
+    std::string pair;
+    while (pairs >> pair) {
+        auto fields = Split(pair, ":");
+        uint32_t freq;
+        int64_t ms;
+        if (fields.size() != 2 || !ParseInt(fields[0], &freq) || !ParseInt(fields[1], &ms)) {
+            return false;
+        }
+        ticks[freq] += ms / 10;
+    }
+    content.clear();
+    for (const auto& [freq, count] : ticks) {
+        content += std::to_string(freq) + " " + std::to_string(count) + "\n";
+    }
+    return WriteNode(nodes, node, content);
+}
+
+// Replays a boot against a fake tree under the root:
+//   <ms> write <node> <value>                node relative to the root
+//   <ms> time_in_state <policy> <kHz>:<ms>...  adds time at frequencies
+//   <ms> start                               takes the boost
+//   <ms> boot_completed
+// Lines before start set the tree up. The boost is released when due
+// between events, after the ones at that time, or after the last one.
+bool Replay(std::istream& in, const Nodes& nodes, BootBoost& boost) {
+    std::string line;
+    int lineno = 0;
+    bool started = false;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, kind;
+        if (!(fields >> time)) continue;
+        int64_t ms;
+        if (!ParseInt(time, &ms) || !(fields >> kind)) {
+            LOG(ERROR) << "replay line " << lineno << ": malformed event";
+            return false;
+        }
+        if (started && !boost.released() && boost.releaseAt() < ms) {
+            boost.poll(boost.releaseAt());
+        }
+
+        bool ok = true;
+        if (kind == "write") {
+            std::string node, value;
+            ok = fields >> node >> value && WriteNode(nodes, node, value);
+        } else if (kind == "time_in_state") {
+            std::string policy;
+            ok = fields >> policy && AddTimeInState(nodes, policy, fields);
+        } else if (kind == "start") {
+            ok = boost.take(ms);
+            started = true;
+        } else if (kind == "boot_completed") {
+            boost.onBootCompleted(ms);
+        } else {
+            LOG(ERROR) << "replay line " << lineno << ": unknown event " << kind;
+            return false;
+        }
+        if (!ok) {
+            LOG(ERROR) << "replay line " << lineno << ": " << kind << " failed";
+            return false;
+        }
+    }
+    if (started) boost.poll(boost.releaseAt());
+    return true;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--settle-ms MS] [--timeout-ms MS]\n"
+            "       %s [--settle-ms MS] [--timeout-ms MS] --root DIR --replay FILE\n",
+            name, name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Params params;
+    std::string root = "/";
+    std::string replay;
+
+    static const option options[] = {
+            {"settle-ms", required_argument, nullptr, 's'},
+            {"timeout-ms", required_argument, nullptr, 't'},
+            {"root", required_argument, nullptr, 'r'},
+            {"replay", required_argument, nullptr, 'p'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:t:r:p:", options, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                if (!ParseInt(optarg, &params.settleMs, int64_t{0})) {
+                    Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 't':
+                if (!ParseInt(optarg, &params.timeoutMs, int64_t{0})) {
+                    Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'r': root = optarg; break;
+            case 'p': replay = optarg; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    Nodes nodes(root);
+    BootBoost boost(params, nodes);
+    if (!replay.empty()) {
+        if (root == "/") {
+            LOG(ERROR) << "Replaying needs --root, it writes to the tree";
+            return 1;
+        }
+        std::ifstream in(replay);
+        if (!in) {
+            PLOG(ERROR) << "Failed to open " << replay;
+            return 1;
+        }
+        if (!Replay(in, nodes, boost)) return 1;
+        boost.writeReport(std::cout);
+        return 0;
+    }
+
+#ifdef __ANDROID__
+    if (!vendor::bootboost::RunLive(boost)) return 1;
+    std::ostringstream report;
+    boost.writeReport(report);
+    for (const auto& line : Split(report.str(), "\n")) {
+        if (!line.empty()) LOG(INFO) << line;
+    }
+    return 0;
+#else
+    Usage(argv[0]);
+    return 1;
+#endif
+}
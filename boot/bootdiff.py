@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Compare two boot traces and check a variant boots without a feature.
+
+  bootdiff.py [--dmesg] [--forbid REGEX...] [--nfc] BASE TRACE
+  bootdiff.py --device [-s SERIAL] [--forbid REGEX...] [--nfc] [BASE]
+
+BASE and TRACE are vendor.bootmon reports (see bootgraph.py) or, with
+--dmesg, kernel logs. The report lists the services and binder
+instances seen in only one of the boots and the start time of the
+shared services in both.
+
+Every service, binder instance or process of TRACE matching a --forbid
+pattern is an error and makes the exit status non-zero. --nfc adds the
+patterns of the NFC stack, so a raphaelin trace checked against a
+raphael one confirms nothing NFC ran:
+
+  bootdiff.py --nfc raphael.txt raphaelin.txt
+
+A pattern that matches nothing in BASE either is a typo or BASE is not a
+boot that has the feature, which is reported as a warning.
+
+--device reads the connected device instead of TRACE: every service init
+started so far (ro.boottime.*), the registered HIDL instances and the
+running processes. Unlike a bootmon report it also covers services
+started on demand after boot completed.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+from bootgraph import Trace, load_dmesg, load_trace
+
+# Services, HALs and apps of the NFC stack: the NFC and secure element
+# HALs, the eSE power manager HAL and daemon and the com.android.nfc process.
+NFC_PATTERNS = [
+    r'nfc',
+    r'secure_?element',
+    r'esepowermanager',
+    r'esepm',
+]
+
+
+class Boot:
+    """Everything that ran in one boot, by name."""
+
+    def __init__(self, trace):
+        self.services = {}
+        for name, states in trace.svc.items():
+            starts = [ms for ms, state in states if state == 'running']
+            if starts:
+                self.services[name] = min(starts)
+        for name, (ms, _) in trace.ready.items():
+            self.services.setdefault(name, ms)
+        self.binders = dict(trace.binders)
+        self.processes = set()
+
+    def names(self):
+        return [('service', name) for name in self.services] + \
+            [('binder', name) for name in self.binders] + \
+            [('process', name) for name in sorted(self.processes)]
+
+
+def adb(serial, *args):
+    command = ['adb'] + (['-s', serial] if serial else []) + list(args)
+    return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+
+
+def load_device(serial):
+    trace = Trace()
+    for line in adb(serial, 'shell', 'getprop').splitlines():
+        match = re.match(r'\[ro\.boottime\.(.*)\]: \[(\d+)\]', line)
+        if match:
+            trace.add(int(match.group(2)) // 1000000, 'svc', [match.group(1), 'running'])
+    for line in adb(serial, 'shell', 'lshal', '--neat', '-i').splitlines():
+        fields = line.split()
+        if fields and '::' in fields[0]:
+            trace.add(0, 'binder', [fields[0]])
+    boot = Boot(trace)
+    for line in adb(serial, 'shell', 'ps', '-A', '-o', 'NAME').splitlines()[1:]:
+        if line.strip():
+            boot.processes.add(line.strip())
+    return boot
+
+
+def fmt(ms):
+    return '%d.%03ds' % (ms // 1000, ms % 1000)
+
+
+def diff(base, boot):
+    for kind, attr in (('service', 'services'), ('binder', 'binders')):
+        ours, theirs = getattr(boot, attr), getattr(base, attr)
+        only_base = sorted(set(theirs) - set(ours))
+        only_trace = sorted(set(ours) - set(theirs))
+        if only_base:
+            print('%ss only in base:' % kind)
+            for name in only_base:
+                print('  %-60s %s' % (name, fmt(theirs[name])))
+        if only_trace:
+            print('%ss only in trace:' % kind)
+            for name in only_trace:
+                print('  %-60s %s' % (name, fmt(ours[name])))
+
+    print('service starts (base -> trace):')
+    for name in sorted(set(base.services) & set(boot.services), key=lambda n: boot.services[n]):
+        delta = boot.services[name] - base.services[name]
+        print('  %-48s %9s %9s %+7dms' % (name, fmt(base.services[name]),
+                                         fmt(boot.services[name]), delta))
+
+
+def check(patterns, base, boot):
+    errors = 0
+    for pattern in patterns:
+        regex = re.compile(pattern, re.IGNORECASE)
+        for kind, name in boot.names():
+            if regex.search(name):
+                print('error: %s %s matches %s' % (kind, name, pattern), file=sys.stderr)
+                errors += 1
+        if base is not None and not any(regex.search(name) for _, name in base.names()):
+            print('warning: %s matches nothing in base either' % pattern, file=sys.stderr)
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-s', '--serial')
+    parser.add_argument('--device', action='store_true', help='read TRACE from the device')
+    parser.add_argument('--dmesg', action='store_true', help='BASE and TRACE are kernel logs')
+    parser.add_argument('--forbid', action='append', default=[], metavar='REGEX')
+    parser.add_argument('--nfc', action='store_true', help='forbid the NFC stack')
+    parser.add_argument('traces', nargs='*')
+    args = parser.parse_args()
+
+    if len(args.traces) not in ((0, 1) if args.device else (2,)):
+        parser.error('expected BASE TRACE, or --device [BASE]')
+
+    load = load_dmesg if args.dmesg else load_trace
+    base = Boot(load(args.traces[0])) if args.traces else None
+    boot = load_device(args.serial) if args.device else Boot(load(args.traces[1]))
+
+    if base is not None:
+        diff(base, boot)
+    patterns = args.forbid + (NFC_PATTERNS if args.nfc else [])
+    errors = check(patterns, base, boot)
+    if patterns:
+        print('%d forbidden entries' % errors)
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
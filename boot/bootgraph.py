@@ -0,0 +1,470 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Build the vendor service graph from rc files and a boot trace.
+
+  bootgraph.py [--deps FILE] [--rc FILE...] [--target NAME...] TRACE
+  bootgraph.py [...] --dmesg DMESG
+
+The trace is the per-boot report written by vendor.bootmon, one event
+per line, times in milliseconds since boot:
+
+  <ms> svc <service> <state>  init.svc.<service> changed (running, stopped, restarting)
+  <ms> binder <instance>      first registration of a binder or HIDL instance
+  <ms> prop <name> <value>    any other property of interest
+
+vendor.bootmon also writes a "# service" summary line per service with
+the readiness it derived from its config (oneshot exit, a binder
+instance the rc files don't declare); when present it takes precedence.
+
+A kernel log with init's "starting service"/"exited" lines can be used
+instead with --dmesg; it carries no binder registrations but does have
+init's "processing action" lines. A bootmon report has no actions, so
+there the time an action ran is taken from the first service it
+started.
+
+Dependencies come from the rc files (start commands, interface lines)
+and from bootgraph.deps, which lists what each daemon needs before it
+can do useful work. The report shows, per service, when it started and
+became ready, how long it waited on its dependencies and how often it
+restarted; the critical path to each target; and proposed class or
+ordering changes with the boot time they would save.
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+# Trigger that runs class_start for each class, see system/core/rootdir/init.rc.
+CLASS_TRIGGERS = {
+    'core': 'boot',
+    'hal': 'boot',
+    'main': 'nonencrypted',
+    'late_start': 'nonencrypted',
+    'charger': 'charger',
+}
+
+# A service that starts this long before its dependencies are ready is
+# worth gating, shorter waits are noise.
+WAIT_THRESHOLD_MS = 50
+
+
+class Service:
+    def __init__(self, name, where):
+        self.name = name
+        self.where = where
+        self.classes = []
+        self.disabled = False
+        self.oneshot = False
+        self.interfaces = []
+        self.started_by = []
+
+
+class Action:
+    def __init__(self, trigger, where):
+        self.trigger = trigger
+        self.where = where
+        self.commands = []
+
+
+def read_logical_lines(path):
+    """Yields (lineno, fields) with backslash continuations joined."""
+    with open(path, 'r') as f:
+        pending, start = '', 0
+        for lineno, line in enumerate(f, 1):
+            stripped = line.strip()
+            if not pending:
+                start = lineno
+            if stripped.endswith('\\'):
+                pending += stripped[:-1] + ' '
+                continue
+            text = pending + stripped
+            pending = ''
+            if text and not text.startswith('#'):
+                yield start, text.split()
+
+
+def parse_rc(paths):
+    services = {}
+    actions = []
+    section = None
+    for path in paths:
+        for lineno, fields in read_logical_lines(path):
+            where = '%s:%d' % (os.path.basename(path), lineno)
+            keyword = fields[0]
+            if keyword == 'service':
+                section = Service(fields[1], where)
+                # Later definitions override earlier ones, like init does
+                # for the same name in a later file.
+                services[fields[1]] = section
+            elif keyword == 'on':
+                section = Action(' '.join(fields[1:]), where)
+                actions.append(section)
+            elif keyword == 'import':
+                section = None
+            elif isinstance(section, Service):
+                if keyword == 'class':
+                    section.classes = fields[1:]
+                elif keyword == 'disabled':
+                    section.disabled = True
+                elif keyword == 'oneshot':
+                    section.oneshot = True
+                elif keyword == 'interface' and len(fields) >= 3:
+                    section.interfaces.append('%s/%s' % (fields[1], fields[2]))
+            elif isinstance(section, Action):
+                section.commands.append(fields)
+
+    for action in actions:
+        for command in action.commands:
+            if command[0] == 'start' and len(command) > 1 and command[1] in services:
+                services[command[1]].started_by.append(action.trigger)
+    return services, actions
+
+
+def load_deps(path):
+    """Returns {service: [needed service or binder instance]}."""
+    deps = {}
+    if not path:
+        return deps
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            name, sep, needs = line.partition(':')
+            if not sep:
+                sys.exit('%s:%d: expected "<service>: <needs...>"' % (path, lineno))
+            deps.setdefault(name.strip(), []).extend(needs.split())
+    return deps
+
+
+class Trace:
+    def __init__(self):
+        self.actions = {}
+        # Actions whose time was estimated, see estimate_actions().
+        self.estimated = set()
+        self.svc = {}
+        self.binders = {}
+        self.props = {}
+        self.ready = {}
+
+    def add(self, ms, kind, args):
+        if kind == 'action':
+            self.actions.setdefault(args[0], ms)
+        elif kind == 'svc':
+            self.svc.setdefault(args[0], []).append((ms, args[1]))
+        elif kind == 'binder':
+            self.binders.setdefault(args[0], ms)
+        elif kind == 'prop':
+            self.props.setdefault((args[0], args[1] if len(args) > 1 else ''), ms)
+
+
+def load_trace(path):
+    trace = Trace()
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            if line.startswith('# service '):
+                fields = line.split()
+                summary = dict(zip(fields[3::2], fields[4::2]))
+                if int(summary.get('ready', -1)) >= 0:
+                    trace.ready[fields[2]] = (int(summary['ready']), summary.get('signal', 'none'))
+                continue
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            try:
+                trace.add(int(fields[0]), fields[1], fields[2:])
+            except (ValueError, IndexError):
+                sys.exit('%s:%d: malformed event: %s' % (path, lineno, line.strip()))
+    return trace
+
+
+DMESG_TIME = r'^\[\s*(\d+\.\d+)\]'
+DMESG_EVENTS = [
+    (re.compile(DMESG_TIME + r".*init: starting service '([^']+)'"), 'svc', 'running'),
+    (re.compile(DMESG_TIME + r".*init: Service '([^']+)' \(pid \d+\) (?:exited|received signal|killed)"),
+     'svc', 'stopped'),
+    (re.compile(DMESG_TIME + r'.*init: processing action \(([^)]+)\)'), 'action', None),
+]
+
+
+def load_dmesg(path):
+    trace = Trace()
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            for regex, kind, state in DMESG_EVENTS:
+                match = regex.search(line)
+                if match:
+                    ms = int(float(match.group(1)) * 1000)
+                    args = [match.group(2)] + ([state] if state else [])
+                    trace.add(ms, kind, args)
+                    break
+    return trace
+
+
+class Node:
+    """Timing of one service (or bare binder instance) in this boot."""
+
+    def __init__(self, name):
+        self.name = name
+        self.service = None
+        self.start = None
+        self.ready = None
+        self.own = 0
+        self.restarts = 0
+        self.signal = 'none'
+        self.needs = []
+        self.wait = 0
+
+
+def build(services, deps, trace):
+    providers = {}
+    for service in services.values():
+        for instance in service.interfaces:
+            providers[instance] = service.name
+
+    names = set(trace.svc) | set(deps)
+    nodes = {}
+    for name in names:
+        node = Node(name)
+        node.service = services.get(name)
+        events = sorted(trace.svc.get(name, []))
+        runs = [ms for ms, state in events if state == 'running']
+        if runs:
+            node.start = runs[0]
+            node.restarts = len(runs) - 1
+        oneshot = node.service is not None and node.service.oneshot
+        registered = [trace.binders[i] for i in (node.service.interfaces if node.service else [])
+                      if i in trace.binders]
+        if oneshot:
+            exits = [ms for ms, state in events if state == 'stopped' and ms >= (node.start or 0)]
+            if exits:
+                node.ready, node.signal = exits[0], 'exit'
+        elif registered:
+            node.ready, node.signal = min(registered), 'binder'
+        if name in trace.ready:
+            node.ready, node.signal = trace.ready[name]
+        if node.ready is None and node.start is not None:
+            # No readiness signal, a running daemon counts as ready once
+            # it stops restarting.
+            node.ready, node.signal = runs[-1], 'running'
+        if node.ready is not None:
+            last_start = max([ms for ms in runs if ms <= node.ready] or [node.ready])
+            node.own = node.ready - last_start
+        nodes[name] = node
+
+    for name, needs in deps.items():
+        for need in needs:
+            if need in providers:
+                need = providers[need]
+            if need not in nodes:
+                # A binder instance nobody in the rc files provides.
+                node = Node(need)
+                node.ready = trace.binders.get(need)
+                node.signal = 'binder' if node.ready is not None else 'none'
+                nodes[need] = node
+            nodes[name].needs.append(need)
+
+    for node in nodes.values():
+        ready = [nodes[n].ready for n in node.needs if nodes[n].ready is not None]
+        if node.start is not None and ready:
+            node.wait = max(0, max(ready) - node.start)
+    return nodes
+
+
+def blocking_dep(nodes, node):
+    """The dependency that became ready last, if node actually waited on it."""
+    ready = [(nodes[n].ready, n) for n in node.needs if nodes[n].ready is not None]
+    if not ready or node.start is None:
+        return None
+    ms, name = max(ready)
+    return name if ms > node.start else None
+
+
+def critical_path(nodes, target):
+    path = []
+    seen = set()
+    name = target
+    while name and name not in seen:
+        seen.add(name)
+        path.append(nodes[name])
+        name = blocking_dep(nodes, nodes[name])
+    return path
+
+
+def start_trigger(service):
+    if service is None:
+        return None
+    if service.started_by:
+        return service.started_by[0]
+    if not service.disabled:
+        for cls in service.classes:
+            if cls in CLASS_TRIGGERS:
+                return CLASS_TRIGGERS[cls]
+    return None
+
+
+def estimate_actions(nodes, trace):
+    """Fills in actions the trace lacks with the first start they caused."""
+    for node in nodes.values():
+        trigger = start_trigger(node.service)
+        if trigger is None or node.start is None:
+            continue
+        if trigger in trace.actions and trigger not in trace.estimated:
+            continue
+        if trigger not in trace.actions or node.start < trace.actions[trigger]:
+            trace.actions[trigger] = node.start
+            trace.estimated.add(trigger)
+
+
+def propose(nodes, trace, critical):
+    """Returns a list of (gain_ms, text) proposals."""
+    proposals = []
+    dependents = {}
+    for node in nodes.values():
+        for need in node.needs:
+            dependents.setdefault(need, []).append(node.name)
+
+    for node in nodes.values():
+        service = node.service
+        if service is None or node.start is None:
+            continue
+        on_path = node.name in critical
+        blocker = blocking_dep(nodes, node)
+
+        # Started before what it needs: gate the start on the dependency.
+        if blocker and (node.wait > WAIT_THRESHOLD_MS or node.restarts):
+            dep = nodes[blocker]
+            if dep.service is not None and dep.signal == 'exit':
+                trigger = 'property:init.svc.%s=stopped' % blocker
+            elif dep.service is not None:
+                trigger = 'property:init.svc.%s=running' % blocker
+            else:
+                trigger = None
+            # Once gated, it starts when the dependency is ready and needs
+            # its own startup time; any retry backoff beyond that is saved.
+            gain = max(0, node.ready - (dep.ready + node.own)) if on_path else 0
+            text = '%s waited %d ms for %s' % (node.name, node.wait, blocker)
+            if node.restarts:
+                text += ' and restarted %d times' % node.restarts
+            if trigger:
+                text += ': make it disabled and start it on %s' % trigger
+            else:
+                text += ': start it after %s registers' % blocker
+            proposals.append((gain, text + ' (%s)' % service.where))
+
+        # On the critical path but started by a late class although its
+        # dependencies were ready earlier: start it as soon as they are.
+        trigger = start_trigger(service)
+        if on_path and not blocker and 'late_start' in service.classes:
+            ready = [(nodes[n].ready, n) for n in node.needs if nodes[n].ready is not None]
+            boot = trace.actions.get('boot')
+            last_ms, last = max(ready) if ready else (0, None)
+            if boot is not None and boot < node.start:
+                gain = node.start - max(boot, last_ms)
+                if last_ms > boot:
+                    dep = nodes[last]
+                    state = 'stopped' if dep.signal == 'exit' else 'running'
+                    change = 'make it disabled and start it on property:init.svc.%s=%s' % (
+                        last, state)
+                else:
+                    change = 'move it from class late_start to core'
+                proposals.append((gain, '%s is on the critical path and its dependencies are ready '
+                                  'at %d ms: %s (%s)' % (node.name, max(boot, last_ms), change,
+                                                         service.where)))
+
+        # Nothing waits for it and it is off the critical path: keep it out
+        # of the way until boot completes.
+        completed = trace.props.get(('sys.boot_completed', '1'))
+        if (not on_path and node.name not in dependents and trigger in ('boot', 'nonencrypted')
+                and completed is not None and node.start < completed
+                and not service.interfaces):
+            proposals.append((0, '%s has no dependents and is off the critical path: consider '
+                              'starting it on property:sys.boot_completed=1 to cut contention '
+                              '(%s)' % (node.name, service.where)))
+    proposals.sort(key=lambda p: -p[0])
+    return proposals
+
+
+def fmt(ms):
+    return '%7d' % ms if ms is not None else '      -'
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..')
+    default_rc = sorted(glob.glob(os.path.join(root, 'rootdir', 'etc', '*.rc')) +
+                        glob.glob(os.path.join(root, '*', '*.rc')))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--rc', nargs='+', default=default_rc)
+    parser.add_argument('--deps', default=os.path.join(here, 'bootgraph.deps'))
+    parser.add_argument('--target', action='append', default=[])
+    parser.add_argument('--dmesg', action='store_true', help='TRACE is a kernel log')
+    parser.add_argument('trace')
+    args = parser.parse_args()
+
+    services, _ = parse_rc(args.rc)
+    deps = load_deps(args.deps)
+    trace = load_dmesg(args.trace) if args.dmesg else load_trace(args.trace)
+    nodes = build(services, deps, trace)
+    estimate_actions(nodes, trace)
+
+    for name in deps:
+        if name not in services:
+            print('warning: %s: %s is not defined in the rc files' % (args.deps, name),
+                  file=sys.stderr)
+
+    print('%-34s %-10s %7s %7s %7s %6s %8s' % ('service', 'class', 'start', 'ready', 'wait',
+                                               'retry', 'signal'))
+    for node in sorted(nodes.values(), key=lambda n: (n.start is None, n.start or 0, n.name)):
+        if node.start is None and node.ready is None:
+            continue
+        cls = ','.join(node.service.classes) if node.service else '-'
+        print('%-34s %-10s %s %s %s %6d %8s' % (node.name, cls or '-', fmt(node.start),
+                                               fmt(node.ready), fmt(node.wait), node.restarts,
+                                               node.signal))
+
+    completed = trace.props.get(('sys.boot_completed', '1'))
+    targets = args.target
+    if not targets:
+        ready = [n for n in nodes.values() if n.ready is not None and
+                 (completed is None or n.ready <= completed)]
+        targets = [max(ready, key=lambda n: n.ready).name] if ready else []
+
+    critical = set()
+    for target in targets:
+        if target not in nodes:
+            sys.exit('unknown target %s' % target)
+        path = critical_path(nodes, target)
+        critical.update(n.name for n in path)
+        print()
+        print('critical path to %s:' % target)
+        for node in path:
+            print('  %s ready %s (started %s, own %d ms)' % (node.name, fmt(node.ready).strip(),
+                                                           fmt(node.start).strip(), node.own))
+        first = path[-1]
+        trigger = start_trigger(first.service)
+        if trigger and trigger in trace.actions:
+            print('  <- started by "%s" at %d ms%s' % (
+                trigger, trace.actions[trigger],
+                ' (its first service start)' if trigger in trace.estimated else ''))
+    if completed is not None:
+        print('\nsys.boot_completed=1 at %d ms' % completed)
+
+    proposals = propose(nodes, trace, critical)
+    if proposals:
+        print('\nproposals (expected boot time gain):')
+        for gain, text in proposals:
+            print('  %5d ms  %s' % (gain, text))
+        print('gains on the same critical path overlap, the total is bounded by the largest.')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "BootMonitor.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+
+using android::base::ParseInt;
+using android::base::Split;
+using android::base::StartsWith;
+using android::base::StringPrintf;
+using android::base::Trim;
+
+namespace vendor {
+namespace bootmon {
+
+namespace {
+
+constexpr char kSvcPrefix[] = "init.svc.";
+constexpr char kBoottimePrefix[] = "ro.boottime.";
+// sys.boot_completed isn't readable from vendor, init mirrors it. The
+// report records it under its own name.
+constexpr char kBootCompleted[] = "vendor.bootmon.boot_completed";
+constexpr char kSysBootCompleted[] = "sys.boot_completed";
+
+}  // namespace
+
+bool ParseConfig(std::istream& in, Config* config, std::string* error) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields;
+        for (const auto& field : Split(line, " \t")) {
+            if (!field.empty()) fields.push_back(field);
+        }
+        int64_t ms;
+        if (fields.size() < 2 || !ParseInt(fields[1], &ms, int64_t{0})) {
+            *error = StringPrintf("line %d: expected <name> <ms>", lineno);
+            return false;
+        }
+        if (fields[0] == "default") {
+            config->defaultBudgetMs = ms;
+        } else if (fields[0] == "grace") {
+            config->graceMs = ms;
+        } else {
+            ServiceConfig& service = config->services[fields[0]];
+            service.budgetMs = ms;
+            for (size_t i = 2; i < fields.size(); i++) {
+                if (fields[i] == "oneshot") {
+                    service.oneshot = true;
+                } else {
+                    service.instances.push_back(fields[i]);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+BootMonitor::BootMonitor(Config config) : mConfig(std::move(config)) {
+    mDefault.budgetMs = mConfig.defaultBudgetMs;
+    for (const auto& [name, service] : mConfig.services) {
+        for (const auto& instance : service.instances) mInstanceOwner[instance] = name;
+    }
+}
+
+const ServiceConfig& BootMonitor::configFor(const std::string& name) const {
+    auto it = mConfig.services.find(name);
+    return it != mConfig.services.end() ? it->second : mDefault;
+}
+
+void BootMonitor::onProperty(int64_t ms, const std::string& name, const std::string& value) {
+    if (StartsWith(name, kSvcPrefix)) {
+        onServiceState(ms, name.substr(sizeof(kSvcPrefix) - 1), value);
+    } else if (StartsWith(name, kBoottimePrefix)) {
+        // init records the first start of every service in nanoseconds,
+        // which is more precise than when we saw it running.
+        int64_t ns;
+        if (!ParseInt(value, &ns, int64_t{0})) return;
+        Service& service = mServices[name.substr(sizeof(kBoottimePrefix) - 1)];
+        int64_t start = ns / 1000000;
+        if (service.start < 0 || start < service.start) service.start = start;
+        if (service.lastStart < 0 || service.restarts == 0) service.lastStart = service.start;
+    } else if ((name == kBootCompleted || name == kSysBootCompleted) && value == "1" &&
+               mBootCompleted < 0) {
+        mBootCompleted = ms;
+        mEvents.push_back(StringPrintf("%" PRId64 " prop sys.boot_completed 1", ms));
+    }
+}
+
+void BootMonitor::onServiceState(int64_t ms, const std::string& name, const std::string& state) {
+    Service& service = mServices[name];
+    if (service.state == state) return;
+    // Services already running when we attach are stamped with init's
+    // own start time.
+    int64_t at = state == "running" && service.state.empty() && service.start >= 0 ? service.start
+                                                                                   : ms;
+    mEvents.push_back(StringPrintf("%" PRId64 " svc %s %s", at, name.c_str(), state.c_str()));
+
+    const ServiceConfig& config = configFor(name);
+    if (state == "running") {
+        if (service.start < 0) {
+            service.start = ms;
+            service.lastStart = ms;
+        } else if (!service.state.empty()) {
+            // Running again after stopping or restarting.
+            service.restarts++;
+            service.lastStart = ms;
+        }
+        // Without a better signal a daemon is ready once it runs; a
+        // restart moves that point.
+        if (!config.oneshot && config.instances.empty()) markReady(service, at, "running");
+    } else if (state == "stopped" && config.oneshot && service.lastStart >= 0) {
+        if (service.ready < 0) markReady(service, ms, "exit");
+    }
+    service.state = state;
+}
+
+void BootMonitor::onBinder(int64_t ms, const std::string& instance) {
+    if (!mBinders.emplace(instance, ms).second) return;
+    mEvents.push_back(StringPrintf("%" PRId64 " binder %s", ms, instance.c_str()));
+
+    auto owner = mInstanceOwner.find(instance);
+    if (owner == mInstanceOwner.end()) return;
+    Service& service = mServices[owner->second];
+    if (service.ready < 0) markReady(service, ms, "binder");
+}
+
+void BootMonitor::markReady(Service& service, int64_t ms, const char* signal) {
+    if (service.ready >= 0 && service.signal != "running") return;
+    service.ready = ms;
+    service.signal = signal;
+}
+
+bool BootMonitor::done(int64_t ms) const {
+    return mBootCompleted >= 0 && ms - mBootCompleted >= mConfig.graceMs;
+}
+
+std::vector<std::string> BootMonitor::overBudget() const {
+    std::vector<std::string> over;
+    for (const auto& [name, service] : mServices) {
+        if (service.start < 0) continue;
+        const ServiceConfig& config = configFor(name);
+        // A oneshot that never exits or a HAL that never registers is
+        // stuck, however long we watched.
+        bool stuck = service.ready < 0 && service.state == "running" &&
+                     (config.oneshot || !config.instances.empty());
+        if (stuck || (service.ready >= 0 && service.ready - service.start > config.budgetMs)) {
+            over.push_back(name);
+        }
+    }
+    return over;
+}
+
+void BootMonitor::writeReport(std::ostream& out, int64_t ms) const {
+    out << "# bootmon 1 at " << ms << "\n";
+    if (mBootCompleted >= 0) out << "# boot_completed " << mBootCompleted << "\n";
+
+    std::vector<std::string> over = overBudget();
+    for (const auto& [name, service] : mServices) {
+        if (service.start < 0) continue;
+        bool flagged = std::find(over.begin(), over.end(), name) != over.end();
+        out << StringPrintf("# service %s start %" PRId64 " ready %" PRId64 " latency %" PRId64
+                            " budget %" PRId64 " restarts %d signal %s%s\n",
+                            name.c_str(), service.start, service.ready,
+                            service.ready >= 0 ? service.ready - service.start : -1,
+                            configFor(name).budgetMs, service.restarts,
+                            service.signal.empty() ? "none" : service.signal.c_str(),
+                            flagged ? " OVER" : "");
+    }
+    for (const auto& event : mEvents) out << event << "\n";
+}
+
+}  // namespace bootmon
+}  // namespace vendor
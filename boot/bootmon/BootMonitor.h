@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vendor {
+namespace bootmon {
+
+struct ServiceConfig {
+    // Start to ready budget, a service over it is flagged in the report.
+    int64_t budgetMs = 0;
+    // Ready when it exits instead of when it is running.
+    bool oneshot = false;
+    // Ready when the first of these binder instances registers.
+    std::vector<std::string> instances;
+};
+
+struct Config {
+    int64_t defaultBudgetMs = 2000;
+    // How long to keep watching after boot completes, to catch late
+    // late_start services.
+    int64_t graceMs = 30000;
+    std::map<std::string, ServiceConfig> services;
+};
+
+// Parses bootmon.conf:
+//   default <budget ms>
+//   grace <ms>
+//   <service> <budget ms> [oneshot] [<binder instance>...]
+bool ParseConfig(std::istream& in, Config* config, std::string* error);
+
+// Tracks init service states and binder registrations during boot.
+// Event sources (the live property area or a replayed stream) feed it
+// timestamped events; it never reads the clock or properties itself.
+class BootMonitor {
+  public:
+    explicit BootMonitor(Config config);
+
+    void onProperty(int64_t ms, const std::string& name, const std::string& value);
+    void onBinder(int64_t ms, const std::string& instance);
+
+    // True once boot completed and the grace period passed.
+    bool done(int64_t ms) const;
+
+    // Services whose start to ready latency exceeded their budget, or
+    // that never became ready.
+    std::vector<std::string> overBudget() const;
+
+    // Summary as comment lines followed by the event trace, in the
+    // format bootgraph.py reads.
+    void writeReport(std::ostream& out, int64_t ms) const;
+
+  private:
+    struct Service {
+        // First start, from ro.boottime.<name> if available.
+        int64_t start = -1;
+        // Start of the attempt that became ready.
+        int64_t lastStart = -1;
+        int64_t ready = -1;
+        int restarts = 0;
+        std::string state;
+        std::string signal;
+    };
+
+    const ServiceConfig& configFor(const std::string& name) const;
+    void onServiceState(int64_t ms, const std::string& name, const std::string& state);
+    void markReady(Service& service, int64_t ms, const char* signal);
+
+    Config mConfig;
+    ServiceConfig mDefault;
+    std::map<std::string, Service> mServices;
+    std::map<std::string, int64_t> mBinders;
+    std::map<std::string, std::string> mInstanceOwner;
+    int64_t mBootCompleted = -1;
+    std::vector<std::string> mEvents;
+};
+
+}  // namespace bootmon
+}  // namespace vendor
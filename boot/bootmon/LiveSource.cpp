@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.bootmon"
+
+#include "LiveSource.h"
+
+#include <sys/system_properties.h>
+#include <time.h>
+
+#include <chrono>
+#include <map>
+#include <thread>
+
+#include <android-base/logging.h>
+#include <android-base/strings.h>
+#include <android/hidl/manager/1.0/IServiceManager.h>
+#include <binder/IServiceManager.h>
+#include <binder/ProcessState.h>
+#include <hidl/ServiceManagement.h>
+
+using android::base::StartsWith;
+
+namespace vendor {
+namespace bootmon {
+
+namespace {
+
+// Rescan at least this often; binder registrations don't bump the
+// property serial.
+constexpr long kPollMs = 100;
+// And at most this often. Boot sets properties in bursts, a full scan
+// and two service manager calls per change would load the boot being
+// measured.
+constexpr int64_t kMinScanMs = 50;
+
+int64_t NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+using Snapshot = std::map<std::string, std::string>;
+
+void ReadProperties(Snapshot* snapshot) {
+    __system_property_foreach(
+            [](const prop_info* pi, void* cookie) {
+                __system_property_read_callback(
+                        pi,
+                        [](void* cookie, const char* name, const char* value, uint32_t) {
+                            if (StartsWith(name, "init.svc.") || StartsWith(name, "ro.boottime.") ||
+                                StartsWith(name, "vendor.bootmon.")) {
+                                (*static_cast<Snapshot*>(cookie))[name] = value;
+                            }
+                        },
+                        cookie);
+            },
+            snapshot);
+}
+
+void ReadBinders(std::vector<std::string>* instances) {
+    auto hwsm = android::hardware::defaultServiceManager();
+    if (hwsm != nullptr) {
+        hwsm->list([&](const auto& list) {
+            for (const auto& name : list) instances->push_back(name);
+        });
+    }
+    auto vndsm = android::defaultServiceManager();
+    if (vndsm != nullptr) {
+        for (const auto& name : vndsm->listServices()) {
+            instances->push_back(android::String8(name).c_str());
+        }
+    }
+}
+
+}  // namespace
+
+int64_t RunLive(BootMonitor& monitor) {
+    android::ProcessState::initWithDriver("/dev/vndbinder");
+
+    Snapshot last;
+    uint32_t serial = 0;
+    while (true) {
+        int64_t now = NowMs();
+        Snapshot current;
+        ReadProperties(&current);
+
+        // Boot times first, so services already running when we attach
+        // get init's start time rather than ours.
+        for (int pass = 0; pass < 2; pass++) {
+            for (const auto& [name, value] : current) {
+                if (StartsWith(name, "ro.boottime.") != (pass == 0)) continue;
+                auto it = last.find(name);
+                if (it == last.end() || it->second != value) monitor.onProperty(now, name, value);
+            }
+        }
+        last = std::move(current);
+
+        std::vector<std::string> instances;
+        ReadBinders(&instances);
+        for (const auto& instance : instances) monitor.onBinder(now, instance);
+
+        if (monitor.done(now)) return now;
+
+        timespec timeout = {0, kPollMs * 1000000};
+        __system_property_wait(nullptr, serial, &serial, &timeout);
+        int64_t early = now + kMinScanMs - NowMs();
+        if (early > 0) std::this_thread::sleep_for(std::chrono::milliseconds(early));
+    }
+}
+
+}  // namespace bootmon
+}  // namespace vendor
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "BootMonitor.h"
+
+namespace vendor {
+namespace bootmon {
+
+// Feeds the monitor from the property area and the hwbinder and
+// vndbinder service managers until it is done. Returns the time it
+// stopped, in milliseconds since boot.
+int64_t RunLive(BootMonitor& monitor);
+
+}  // namespace bootmon
+}  // namespace vendor
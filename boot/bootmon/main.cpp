@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.bootmon"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+
+#include "BootMonitor.h"
+#ifdef __ANDROID__
+#include "LiveSource.h"
+#endif
+
+using android::base::ParseInt;
+using android::base::StringPrintf;
+using android::base::WriteStringToFile;
+using vendor::bootmon::BootMonitor;
+using vendor::bootmon::Config;
+using vendor::bootmon::ParseConfig;
+
+namespace {
+
+constexpr char kDefaultConfig[] = "/vendor/etc/bootmon.conf";
+constexpr char kDefaultOut[] = "/data/vendor/bootmon";
+// boot.txt is the last boot, boot.1.txt the one before and so on.
+constexpr int kKeepReports = 5;
+
+// Replays "<ms> prop <name> <value>" and "<ms> binder <instance>" lines,
+// the same stream the live source produces, and "<ms> svc <name> <state>"
+// lines so a report can be replayed against another config.
+bool Replay(std::istream& in, BootMonitor& monitor, int64_t* last) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        // A report's header holds the time it was written.
+        if (sscanf(line.c_str(), "# bootmon 1 at %" SCNd64, last) == 1) continue;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, kind, name, value;
+        if (!(fields >> time)) continue;
+        int64_t ms;
+        if (!ParseInt(time, &ms) || !(fields >> kind >> name)) {
+            LOG(ERROR) << "replay line " << lineno << ": malformed event";
+            return false;
+        }
+        if (kind == "prop") {
+            fields >> value;
+            monitor.onProperty(ms, name, value);
+        } else if (kind == "svc") {
+            fields >> value;
+            monitor.onProperty(ms, "init.svc." + name, value);
+        } else if (kind == "binder") {
+            monitor.onBinder(ms, name);
+        } else {
+            LOG(ERROR) << "replay line " << lineno << ": unknown event " << kind;
+            return false;
+        }
+        *last = std::max(*last, ms);
+        if (monitor.done(ms)) break;
+    }
+    return true;
+}
+
+bool WriteReport(const BootMonitor& monitor, int64_t ms, const std::string& dir) {
+    for (int i = kKeepReports - 1; i > 0; i--) {
+        std::string from = i == 1 ? dir + "/boot.txt"
+                                  : StringPrintf("%s/boot.%d.txt", dir.c_str(), i - 1);
+        rename(from.c_str(), StringPrintf("%s/boot.%d.txt", dir.c_str(), i).c_str());
+    }
+    std::ostringstream report;
+    monitor.writeReport(report, ms);
+    std::string tmp = dir + "/boot.txt.tmp";
+    if (!WriteStringToFile(report.str(), tmp) || rename(tmp.c_str(), (dir + "/boot.txt").c_str())) {
+        PLOG(ERROR) << "Failed to write report to " << dir;
+        return false;
+    }
+    return true;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--config FILE] [--out DIR] [--replay FILE]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string configPath = kDefaultConfig;
+    std::string out;
+    std::string replay;
+
+    static const option options[] = {
+            {"config", required_argument, nullptr, 'c'},
+            {"out", required_argument, nullptr, 'o'},
+            {"replay", required_argument, nullptr, 'r'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:o:r:", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'c': configPath = optarg; break;
+            case 'o': out = optarg; break;
+            case 'r': replay = optarg; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    Config config;
+    std::ifstream configFile(configPath);
+    std::string error;
+    if (!configFile) {
+        LOG(WARNING) << "No " << configPath << ", using default budgets";
+    } else if (!ParseConfig(configFile, &config, &error)) {
+        LOG(ERROR) << configPath << ": " << error;
+        return 1;
+    }
+    BootMonitor monitor(std::move(config));
+
+    int64_t ms = 0;
+    if (!replay.empty()) {
+        std::ifstream in(replay);
+        if (!in) {
+            PLOG(ERROR) << "Failed to open " << replay;
+            return 1;
+        }
+        if (!Replay(in, monitor, &ms)) return 1;
+    } else {
+#ifdef __ANDROID__
+        ms = vendor::bootmon::RunLive(monitor);
+        if (out.empty()) out = kDefaultOut;
+#else
+        Usage(argv[0]);
+        return 1;
+#endif
+    }
+
+    for (const auto& name : monitor.overBudget()) {
+        LOG(WARNING) << name << " exceeded its boot budget";
+    }
+    if (out.empty()) {
+        monitor.writeReport(std::cout, ms);
+        return 0;
+    }
+    return WriteReport(monitor, ms, out) ? 0 : 1;
+}
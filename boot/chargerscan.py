@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""List what init runs when the device boots into off-mode charging.
+
+  chargerscan.py [--rc FILE...] [--props FILE...] [--prop KEY=VALUE...]
+  chargerscan.py [...] --dmesg DMESG
+
+In charger mode init queues early-init, init and charger instead of
+late-init, so no filesystem is mounted and class_start only runs for the
+classes the charger actions name. This replays that sequence over the
+rc files: every action whose trigger holds, in the order init runs it,
+with its commands; the property triggers the setprops on the way fire;
+and each service that gets started and why. Properties come from the
+build prop files plus ro.bootmode=charger, --prop overrides them.
+
+The platform init.rc is not part of this tree; its "on charger" only
+does class_start charger, which is assumed. Blob rc files are not here
+either, so for the full picture pass a kernel log of a charger boot
+with --dmesg: every action and service start init logged is listed and
+marked if the rc files here don't account for it.
+
+Conditions init can never satisfy (a "!=" that init parses as a
+property name) and service definitions init ignores as duplicates are
+reported as warnings.
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+from bootgraph import read_logical_lines
+
+EVENT_TRIGGERS = ['early-init', 'init', 'charger']
+
+# Done by the platform init.rc in charger mode.
+PLATFORM_CHARGER_CLASSES = ['charger']
+
+# Defined by the platform init.rc, which init parses before any of these,
+# with their classes.
+PLATFORM_SERVICES = {'charger': ['charger']}
+
+PROP_FILES = ['vendor.prop', 'odm.prop', 'system.prop', 'system_ext.prop']
+
+
+class Service:
+    def __init__(self, name, where):
+        self.name = name
+        self.where = where
+        self.classes = ['default']
+        self.disabled = False
+        self.override = False
+
+
+class Action:
+    def __init__(self, trigger, where):
+        self.trigger = trigger
+        self.where = where
+        self.event = None
+        self.conditions = []
+        self.commands = []
+        for term in trigger.split('&&'):
+            term = term.strip()
+            if term.startswith('property:'):
+                name, _, value = term[len('property:'):].partition('=')
+                self.conditions.append((name, value))
+            else:
+                self.event = term
+
+
+class Rc:
+    def __init__(self):
+        self.services = {}
+        self.actions = []
+        self.warnings = []
+
+
+def parse(paths, root):
+    """Parses the rc files in init's order: root, its imports, the rest."""
+    by_name = {os.path.basename(path): path for path in paths}
+    order = [by_name[root]] if root in by_name else []
+    rest = sorted(p for p in paths if os.path.basename(p) != root)
+    rc = Rc()
+    definitions = []
+    section = None
+    parsed = set()
+    while order or rest:
+        path = order.pop(0) if order else rest.pop(0)
+        if path in parsed:
+            continue
+        parsed.add(path)
+        imports = []
+        for lineno, fields in read_logical_lines(path):
+            where = '%s:%d' % (os.path.basename(path), lineno)
+            keyword = fields[0]
+            if keyword == 'import':
+                name = os.path.basename(fields[1])
+                if name in by_name:
+                    imports.append(by_name[name])
+                section = None
+            elif keyword == 'service':
+                section = Service(fields[1], where)
+                definitions.append(section)
+            elif keyword == 'on':
+                section = Action(' '.join(fields[1:]), where)
+                rc.actions.append(section)
+                for name, _ in section.conditions:
+                    if name.endswith('!'):
+                        rc.warnings.append('%s: "property:%s=" has no "!=" in init, this '
+                                           'action never runs' % (where, name))
+            elif isinstance(section, Service):
+                if keyword == 'class':
+                    section.classes = fields[1:]
+                elif keyword == 'disabled':
+                    section.disabled = True
+                elif keyword == 'override':
+                    section.override = True
+            elif isinstance(section, Action):
+                section.commands.append(fields)
+        # Imports are parsed right after the importing file.
+        order = imports + order
+
+    # The first definition of a service wins, a later one replaces it only
+    # with "override".
+    for service in definitions:
+        if service.name in rc.services or service.name in PLATFORM_SERVICES:
+            if service.override:
+                rc.services[service.name] = service
+            else:
+                rc.warnings.append('%s: service %s is already defined, init ignores this '
+                                   'definition' % (service.where, service.name))
+        else:
+            rc.services[service.name] = service
+
+    return rc
+
+
+def load_props(paths):
+    props = {}
+    for path in paths:
+        if not os.path.exists(path):
+            continue
+        with open(path, 'r') as f:
+            for line in f:
+                line = line.strip()
+                if line and not line.startswith('#') and '=' in line:
+                    key, value = line.split('=', 1)
+                    props[key.strip()] = value.strip()
+    return props
+
+
+def expand(value, props):
+    return re.sub(r'\$\{([^}:]+)(?::-([^}]*))?\}',
+                  lambda m: props.get(m.group(1), m.group(2) or ''), value)
+
+
+def holds(conditions, props):
+    return all(name in props and (value == '*' or props[name] == value)
+               for name, value in conditions)
+
+
+class Simulation:
+    def __init__(self, rc, props):
+        self.rc = rc
+        self.props = props
+        self.ran = []
+        self.started = {}
+        self.classes = set()
+        self.queue = []
+
+    def start(self, name, why):
+        if (name in self.rc.services or name in PLATFORM_SERVICES) and name not in self.started:
+            self.started[name] = why
+
+    def run(self, action):
+        self.ran.append(action)
+        for command in action.commands:
+            verb, args = command[0], command[1:]
+            if verb == 'setprop' and len(args) >= 2:
+                self.setprop(args[0], expand(' '.join(args[1:]), self.props))
+            elif verb in ('start', 'restart') and args:
+                self.start(args[0], action.where)
+            elif verb == 'enable' and args:
+                service = self.rc.services.get(args[0])
+                if service and self.classes & set(service.classes):
+                    self.start(args[0], action.where)
+            elif verb in ('class_start', 'class_restart') and args:
+                self.class_start(args[0], action.where)
+            elif verb == 'trigger' and args:
+                self.queue.append(args[0])
+
+    def class_start(self, cls, why):
+        self.classes.add(cls)
+        for name, classes in PLATFORM_SERVICES.items():
+            if cls in classes:
+                self.start(name, '%s (class_start %s)' % (why, cls))
+        for service in self.rc.services.values():
+            if cls in service.classes and not service.disabled:
+                self.start(service.name, '%s (class_start %s)' % (why, cls))
+
+    def setprop(self, name, value):
+        if self.props.get(name) == value:
+            return
+        self.props[name] = value
+        for action in self.rc.actions:
+            if action.event is None and any(n == name for n, _ in action.conditions) and \
+                    holds(action.conditions, self.props):
+                self.run(action)
+
+    def boot(self):
+        self.queue = list(EVENT_TRIGGERS)
+        while self.queue:
+            trigger = self.queue.pop(0)
+            for action in self.rc.actions:
+                if action.event == trigger and holds(action.conditions, self.props):
+                    self.run(action)
+            if trigger == 'charger':
+                for cls in PLATFORM_CHARGER_CLASSES:
+                    self.class_start(cls, 'init.rc (on charger)')
+        # queue_property_triggers: actions whose properties already held.
+        for action in self.rc.actions:
+            if action.event is None and action not in self.ran and \
+                    holds(action.conditions, self.props):
+                self.run(action)
+
+
+DMESG_ACTION = re.compile(r'^\[\s*(\d+\.\d+)\].*init: processing action \(([^)]+)\)'
+                          r'(?: from \(([^)]+)\))?')
+DMESG_SERVICE = re.compile(r"^\[\s*(\d+\.\d+)\].*init: starting service '([^']+)'")
+
+
+def scan_dmesg(path, sim):
+    known = {action.where for action in sim.ran}
+    charger = None
+    print('\nfrom %s:' % path)
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            match = DMESG_ACTION.search(line)
+            if match:
+                source = match.group(3) or ''
+                where = '%s:%s' % (os.path.basename(source.rsplit(':', 1)[0]),
+                                   source.rsplit(':', 1)[-1]) if source else ''
+                mark = '' if where in known or not where else '  (not in these rc files)'
+                print('  %10ss  on %-40s %s%s' % (match.group(1), match.group(2), source, mark))
+                continue
+            match = DMESG_SERVICE.search(line)
+            if match:
+                mark = '' if match.group(2) in sim.started else '  (not predicted)'
+                print('  %10ss  start %s%s' % (match.group(1), match.group(2), mark))
+                if match.group(2) == 'charger' and charger is None:
+                    charger = match.group(1)
+    if charger is not None:
+        print('charger UI started at %ss' % charger)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..')
+    default_rc = sorted(p for p in glob.glob(os.path.join(root, '**', '*.rc'), recursive=True)
+                        if 'recovery' not in os.path.basename(p))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--rc', nargs='+', default=default_rc)
+    parser.add_argument('--root', default='init.qcom.rc', help='rc file init imports first')
+    parser.add_argument('--props', nargs='+',
+                        default=[os.path.join(root, name) for name in PROP_FILES])
+    parser.add_argument('--prop', action='append', default=[], metavar='KEY=VALUE')
+    parser.add_argument('--dmesg', help='kernel log of a charger boot')
+    args = parser.parse_args()
+
+    rc = parse(args.rc, args.root)
+    props = load_props(args.props)
+    props.update({'ro.bootmode': 'charger', 'ro.boot.mode': 'charger'})
+    for item in args.prop:
+        key, _, value = item.partition('=')
+        props[key] = value
+
+    sim = Simulation(rc, props)
+    sim.boot()
+
+    for action in sim.ran:
+        print('%-28s on %s' % (action.where, action.trigger))
+        for command in action.commands:
+            print('    %s' % ' '.join(command))
+    print('\nservices:')
+    for name, why in sim.started.items():
+        service = rc.services.get(name)
+        classes = service.classes if service else PLATFORM_SERVICES[name]
+        print('  %-36s %-12s %s' % (name, ','.join(classes), why))
+    print('\n%d actions, %d commands, %d services' % (
+        len(sim.ran), sum(len(a.commands) for a in sim.ran), len(sim.started)))
+
+    for message in rc.warnings:
+        print('warning: ' + message, file=sys.stderr)
+
+    if args.dmesg:
+        scan_dmesg(args.dmesg, sim)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Break down the recovery boot time from a kernel log.
+
+  recoverytime.py [--budget MS] DMESG
+  recoverytime.py [--budget MS] --device [-s SERIAL]
+
+Reads the log init writes to the kernel log while booting recovery: the
+two init stages, vendor_load_properties (logged by init_xiaomi_raphael),
+the first run of each action trigger, the service starts and every
+command or wait init reports as slow. The boot counts as done when the
+recovery service starts; the exit status is non-zero if that is later
+than the budget.
+
+--device reads the log of a device that is in recovery right now.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+# From kernel start to the recovery service.
+DEFAULT_BUDGET_MS = 5000
+
+TIME = r'^\[\s*(\d+\.\d+)\]'
+EVENTS = [
+    ('stage', re.compile(TIME + r'.*init: init (first|second) stage started')),
+    ('vendor', re.compile(TIME + r'.*init: vendor_load_properties took (\d+)ms')),
+    ('action', re.compile(TIME + r'.*init: processing action \(([^)]+)\)')),
+    ('service', re.compile(TIME + r".*init: starting service '([^']+)'")),
+    ('slow', re.compile(TIME + r".*init: (Command '[^']*'.*took \d+ms|wait for '[^']*' took \d+ms)")),
+]
+
+DONE_SERVICE = 'recovery'
+
+
+def parse(lines):
+    events = []
+    seen = set()
+    for line in lines:
+        for kind, regex in EVENTS:
+            match = regex.search(line)
+            if not match:
+                continue
+            ms = int(float(match.group(1)) * 1000)
+            what = match.group(2)
+            if kind == 'action':
+                # Property actions repeat, only the first run of a trigger
+                # marks a phase.
+                if what in seen:
+                    break
+                seen.add(what)
+            events.append((ms, kind, what))
+            break
+    return events
+
+
+def adb(serial, *args):
+    command = ['adb'] + (['-s', serial] if serial else []) + list(args)
+    return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-s', '--serial')
+    parser.add_argument('--device', action='store_true')
+    parser.add_argument('--budget', type=int, default=DEFAULT_BUDGET_MS, metavar='MS')
+    parser.add_argument('dmesg', nargs='?')
+    args = parser.parse_args()
+    if bool(args.device) == bool(args.dmesg):
+        parser.error('expected DMESG or --device')
+
+    if args.device:
+        lines = adb(args.serial, 'shell', 'dmesg').splitlines()
+    else:
+        with open(args.dmesg, 'r', errors='replace') as f:
+            lines = f.readlines()
+
+    events = parse(lines)
+    done = None
+    last = 0
+    for ms, kind, what in events:
+        if kind == 'stage':
+            label = 'init %s stage' % what
+        elif kind == 'vendor':
+            label = 'vendor_load_properties %sms' % what
+        elif kind == 'action':
+            label = 'on %s' % what
+        elif kind == 'service':
+            label = 'start %s' % what
+        else:
+            label = what
+        print('%6d.%03ds %+6dms  %s' % (ms // 1000, ms % 1000, ms - last, label))
+        last = ms
+        if kind == 'service' and what == DONE_SERVICE and done is None:
+            done = ms
+
+    if done is None:
+        print('error: the %s service never started, is this a recovery boot?' % DONE_SERVICE,
+              file=sys.stderr)
+        return 1
+    print('recovery started at %dms, budget %dms' % (done, args.budget))
+    return 1 if done > args.budget else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
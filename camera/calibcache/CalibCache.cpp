@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.camera.calibcache"
+
+#include "CalibCache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <android-base/unique_fd.h>
+#include <zlib.h>
+
+using android::base::ParseInt;
+using android::base::ParseUint;
+using android::base::Split;
+using android::base::StringPrintf;
+using android::base::unique_fd;
+
+namespace vendor {
+namespace camera {
+namespace calib {
+
+namespace {
+
+size_t Align(size_t value) {
+    return (value + kBlobAlign - 1) & ~(kBlobAlign - 1);
+}
+
+size_t TableEnd(size_t count) {
+    return Align(sizeof(ImageHeader) + count * sizeof(ImageEntry));
+}
+
+std::vector<std::string> ListFiles(const std::string& dir, const std::string& prefix, int depth) {
+    std::vector<std::string> names;
+    std::unique_ptr<DIR, decltype(&closedir)> d(opendir((dir + "/" + prefix).c_str()), closedir);
+    if (!d) return names;
+    while (dirent* entry = readdir(d.get())) {
+        if (entry->d_name[0] == '.') continue;
+        std::string name = prefix + entry->d_name;
+        struct stat st;
+        if (stat((dir + "/" + name).c_str(), &st)) continue;
+        if (S_ISREG(st.st_mode)) {
+            names.push_back(name);
+        } else if (S_ISDIR(st.st_mode) && depth > 0) {
+            auto sub = ListFiles(dir, name + "/", depth - 1);
+            names.insert(names.end(), sub.begin(), sub.end());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+}  // namespace
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+    return crc32(crc32(0L, Z_NULL, 0), data, size);
+}
+
+bool ParseManifest(const std::string& content, Manifest* manifest, std::string* error) {
+    manifest->clear();
+    int lineno = 0;
+    for (const auto& line : Split(content, "\n")) {
+        lineno++;
+        if (line.empty()) continue;
+        auto fields = Split(line, " ");
+        ManifestEntry entry;
+        if (fields.size() != 4 || !ParseUint("0x" + fields[0], &entry.crc) ||
+            !ParseUint(fields[1], &entry.size) || !ParseInt(fields[2], &entry.mtime)) {
+            *error = StringPrintf("line %d: expected <crc> <size> <mtime> <name>", lineno);
+            return false;
+        }
+        (*manifest)[fields[3]] = entry;
+    }
+    return true;
+}
+
+std::string FormatManifest(const Manifest& manifest) {
+    std::string out;
+    for (const auto& [name, entry] : manifest) {
+        out += StringPrintf("%08x %" PRIu64 " %" PRId64 " %s\n", entry.crc, entry.size,
+                            entry.mtime, name.c_str());
+    }
+    return out;
+}
+
+CalibCache::~CalibCache() {
+    for (const auto& blob : mBlobs) {
+        munmap(const_cast<uint8_t*>(blob.data), blob.size);
+    }
+}
+
+bool CalibCache::load(const std::string& dir, const Manifest& previous, size_t maxBytes,
+                      std::string* error) {
+    struct stat st;
+    if (stat(dir.c_str(), &st) || !S_ISDIR(st.st_mode)) {
+        *error = "no directory " + dir;
+        return false;
+    }
+    size_t budget = maxBytes;
+    for (const auto& name : ListFiles(dir, "", 1)) {
+        mapFile(dir, name, &budget, previous);
+    }
+    return true;
+}
+
+void CalibCache::mapFile(const std::string& dir, const std::string& name, size_t* budget,
+                         const Manifest& previous) {
+    if (name.size() >= kNameMax) {
+        LOG(WARNING) << "Skipping " << name << ": name too long";
+        return;
+    }
+    std::string path = dir + "/" + name;
+    unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st)) {
+        PLOG(WARNING) << "Skipping " << path;
+        return;
+    }
+    if (st.st_size == 0) return;
+    if (static_cast<size_t>(st.st_size) > *budget) {
+        LOG(WARNING) << "Skipping " << path << ": " << st.st_size << " bytes, " << *budget
+                     << " left in the budget";
+        mOversized.push_back(name);
+        return;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    if (data == MAP_FAILED) {
+        PLOG(WARNING) << "Skipping " << path;
+        return;
+    }
+    Blob blob;
+    blob.name = name;
+    blob.data = static_cast<const uint8_t*>(data);
+    blob.size = st.st_size;
+    blob.mtime = st.st_mtime;
+    blob.crc = Crc32(blob.data, blob.size);
+
+    // Calibration is written once at the factory. Same size and mtime
+    // with different contents means the file rotted, not that it was
+    // recalibrated.
+    auto known = previous.find(name);
+    if (known != previous.end() && known->second.size == blob.size &&
+        known->second.mtime == blob.mtime && known->second.crc != blob.crc) {
+        LOG(ERROR) << path << ": checksum " << StringPrintf("%08x", blob.crc) << ", recorded "
+                   << StringPrintf("%08x", known->second.crc);
+        munmap(data, blob.size);
+        mCorrupt.push_back(name);
+        return;
+    }
+    *budget -= blob.size;
+    mBlobs.push_back(blob);
+}
+
+bool CalibCache::pin() {
+    bool ok = true;
+    for (const auto& blob : mBlobs) {
+        if (mlock(blob.data, blob.size)) {
+            PLOG(WARNING) << "Failed to lock " << blob.name;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+Manifest CalibCache::manifest() const {
+    Manifest manifest;
+    for (const auto& blob : mBlobs) {
+        manifest[blob.name] = ManifestEntry{blob.size, blob.mtime, blob.crc};
+    }
+    return manifest;
+}
+
+size_t CalibCache::imageSize() const {
+    size_t size = TableEnd(mBlobs.size());
+    for (const auto& blob : mBlobs) size += Align(blob.size);
+    return size;
+}
+
+void CalibCache::writeImage(uint8_t* out) const {
+    size_t size = imageSize();
+    memset(out, 0, TableEnd(mBlobs.size()));
+    auto* header = reinterpret_cast<ImageHeader*>(out);
+    header->magic = kImageMagic;
+    header->version = kImageVersion;
+    header->count = mBlobs.size();
+    header->size = size;
+
+    auto* entries = reinterpret_cast<ImageEntry*>(out + sizeof(ImageHeader));
+    size_t offset = TableEnd(mBlobs.size());
+    for (size_t i = 0; i < mBlobs.size(); i++) {
+        const Blob& blob = mBlobs[i];
+        strncpy(entries[i].name, blob.name.c_str(), kNameMax - 1);
+        entries[i].offset = offset;
+        entries[i].size = blob.size;
+        entries[i].crc = blob.crc;
+        memcpy(out + offset, blob.data, blob.size);
+        memset(out + offset + blob.size, 0, Align(blob.size) - blob.size);
+        offset += Align(blob.size);
+    }
+}
+
+bool ImageView::open(const uint8_t* image, size_t size, std::string* error) {
+    mImage = nullptr;
+    mEntries.clear();
+    if (size < sizeof(ImageHeader)) {
+        *error = "image too small";
+        return false;
+    }
+    const auto* header = reinterpret_cast<const ImageHeader*>(image);
+    if (header->magic != kImageMagic || header->version != kImageVersion) {
+        *error = "not a calibration image";
+        return false;
+    }
+    if (header->size != size || header->count > size / sizeof(ImageEntry) ||
+        TableEnd(header->count) > size) {
+        *error = "image size mismatch";
+        return false;
+    }
+    const auto* entries = reinterpret_cast<const ImageEntry*>(image + sizeof(ImageHeader));
+    for (uint32_t i = 0; i < header->count; i++) {
+        const ImageEntry& entry = entries[i];
+        if (memchr(entry.name, '\0', kNameMax) == nullptr || entry.offset > size ||
+            entry.size > size - entry.offset) {
+            *error = StringPrintf("entry %u out of bounds", i);
+            return false;
+        }
+        if (Crc32(image + entry.offset, entry.size) != entry.crc) {
+            *error = StringPrintf("%s: checksum mismatch", entry.name);
+            return false;
+        }
+        mEntries.push_back(&entry);
+    }
+    mImage = image;
+    return true;
+}
+
+const uint8_t* ImageView::find(const std::string& name, size_t* size) const {
+    for (const auto* entry : mEntries) {
+        if (name == entry->name) {
+            *size = entry->size;
+            return mImage + entry->offset;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace calib
+}  // namespace camera
+}  // namespace vendor
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vendor {
+namespace camera {
+namespace calib {
+
+// Layout of the shared image: a header, the entry table, then the blobs,
+// each aligned to kBlobAlign.
+constexpr uint32_t kImageMagic = 0x434c4143;  // "CALC"
+constexpr uint32_t kImageVersion = 1;
+constexpr size_t kNameMax = 96;
+constexpr size_t kBlobAlign = 64;
+
+struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+struct ImageEntry {
+    // Path relative to the calibration directory, NUL terminated.
+    char name[kNameMax];
+    uint64_t offset;
+    uint64_t size;
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+// What was recorded for a file the last time it was loaded.
+struct ManifestEntry {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint32_t crc = 0;
+};
+using Manifest = std::map<std::string, ManifestEntry>;
+
+// "<crc hex> <size> <mtime> <name>" per line.
+bool ParseManifest(const std::string& content, Manifest* manifest, std::string* error);
+std::string FormatManifest(const Manifest& manifest);
+
+// One calibration file, mapped read-only for the lifetime of the cache.
+struct Blob {
+    std::string name;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    int64_t mtime = 0;
+    uint32_t crc = 0;
+};
+
+uint32_t Crc32(const uint8_t* data, size_t size);
+
+class CalibCache {
+  public:
+    CalibCache() = default;
+    ~CalibCache();
+    CalibCache(const CalibCache&) = delete;
+    CalibCache& operator=(const CalibCache&) = delete;
+
+    // Maps every regular file under dir (one level of subdirectories),
+    // up to maxBytes in total. Files that fail the manifest check are
+    // reported in corrupt(), files that do not fit in what is left of
+    // maxBytes in oversized(), and both are left out.
+    bool load(const std::string& dir, const Manifest& previous, size_t maxBytes,
+              std::string* error);
+
+    // Locks the mappings so the page cache keeps them; readers of the
+    // original files hit memory as well.
+    bool pin();
+
+    const std::vector<Blob>& blobs() const { return mBlobs; }
+    const std::vector<std::string>& corrupt() const { return mCorrupt; }
+    const std::vector<std::string>& oversized() const { return mOversized; }
+    Manifest manifest() const;
+
+    // Size of the shared image and the image itself, see ImageHeader.
+    size_t imageSize() const;
+    void writeImage(uint8_t* out) const;
+
+  private:
+    void mapFile(const std::string& dir, const std::string& name, size_t* budget,
+                 const Manifest& previous);
+
+    std::vector<Blob> mBlobs;
+    std::vector<std::string> mCorrupt;
+    std::vector<std::string> mOversized;
+};
+
+// Read-only view of a shared image.
+class ImageView {
+  public:
+    // Checks the header, the table bounds and every blob's checksum.
+    bool open(const uint8_t* image, size_t size, std::string* error);
+
+    size_t count() const { return mEntries.size(); }
+    const ImageEntry& entry(size_t i) const { return *mEntries[i]; }
+    // nullptr if there is no such blob.
+    const uint8_t* find(const std::string& name, size_t* size) const;
+
+  private:
+    const uint8_t* mImage = nullptr;
+    std::vector<const ImageEntry*> mEntries;
+};
+
+}  // namespace calib
+}  // namespace camera
+}  // namespace vendor
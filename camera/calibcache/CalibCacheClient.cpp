@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "CalibCacheClient.h"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <cstring>
+
+#include <android-base/cmsg.h>
+#include <android-base/unique_fd.h>
+
+using android::base::ReceiveFileDescriptors;
+using android::base::unique_fd;
+
+namespace vendor {
+namespace camera {
+namespace calib {
+
+CalibCacheClient::~CalibCacheClient() {
+    if (mImage) munmap(mImage, mSize);
+}
+
+bool CalibCacheClient::connect(const std::string& socketPath, std::string* error) {
+    unique_fd sock(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (sock < 0 || ::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+        *error = "connect " + socketPath + ": " + strerror(errno);
+        return false;
+    }
+    uint64_t size = 0;
+    unique_fd image;
+    if (ReceiveFileDescriptors(sock, &size, sizeof(size), &image) != sizeof(size) || image < 0) {
+        *error = "no image from " + socketPath;
+        return false;
+    }
+    return attach(image, size, error);
+}
+
+bool CalibCacheClient::attach(int fd, size_t size, std::string* error) {
+    void* image = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        *error = std::string("mmap: ") + strerror(errno);
+        return false;
+    }
+    ImageView view;
+    if (!view.open(static_cast<const uint8_t*>(image), size, error)) {
+        munmap(image, size);
+        return false;
+    }
+    if (mImage) munmap(mImage, mSize);
+    mImage = image;
+    mSize = size;
+    mView = view;
+    return true;
+}
+
+}  // namespace calib
+}  // namespace camera
+}  // namespace vendor
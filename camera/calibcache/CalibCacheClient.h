@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "CalibCache.h"
+
+namespace vendor {
+namespace camera {
+namespace calib {
+
+// init creates it for vendor.camera.calibcache, see the rc file.
+constexpr char kSocketName[] = "camera_calib";
+
+// Maps the calibration image shared by vendor.camera.calibcache.
+// Lookups hit memory instead of persist; the mapping is read-only and
+// stays valid after the service restarts.
+class CalibCacheClient {
+  public:
+    CalibCacheClient() = default;
+    ~CalibCacheClient();
+    CalibCacheClient(const CalibCacheClient&) = delete;
+    CalibCacheClient& operator=(const CalibCacheClient&) = delete;
+
+    // Fetches the image from the service socket.
+    bool connect(const std::string& socketPath, std::string* error);
+    // Maps an image fd directly, the fd is not kept.
+    bool attach(int fd, size_t size, std::string* error);
+
+    const ImageView& view() const { return mView; }
+
+  private:
+    void* mImage = nullptr;
+    size_t mSize = 0;
+    ImageView mView;
+};
+
+}  // namespace calib
+}  // namespace camera
+}  // namespace vendor
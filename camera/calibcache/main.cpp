@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.camera.calibcache"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <android-base/cmsg.h>
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/unique_fd.h>
+#include <cutils/ashmem.h>
+#ifdef __ANDROID__
+#include <cutils/sockets.h>
+#endif
+
+#include "CalibCache.h"
+#include "CalibCacheClient.h"
+
+using android::base::ParseUint;
+using android::base::ReadFileToString;
+using android::base::SendFileDescriptors;
+using android::base::unique_fd;
+using android::base::WriteStringToFile;
+using vendor::camera::calib::CalibCache;
+using vendor::camera::calib::CalibCacheClient;
+using vendor::camera::calib::FormatManifest;
+using vendor::camera::calib::Manifest;
+using vendor::camera::calib::ParseManifest;
+
+namespace {
+
+constexpr char kDefaultDir[] = "/mnt/vendor/persist/camera";
+constexpr char kDefaultManifest[] = "/data/vendor/camera/calib_cache.manifest";
+// The whole of persist/camera is a few MB; anything far beyond that is
+// not calibration and should not be pinned.
+constexpr size_t kDefaultMaxBytes = 32 << 20;
+
+// Copies the blobs into a sealed, read-only shared memory region.
+unique_fd CreateImage(const CalibCache& cache, size_t* size) {
+    *size = cache.imageSize();
+    unique_fd fd(ashmem_create_region("camera_calib", *size));
+    if (fd < 0) {
+        PLOG(ERROR) << "Failed to create shared memory";
+        return {};
+    }
+    void* image = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map shared memory";
+        return {};
+    }
+    cache.writeImage(static_cast<uint8_t*>(image));
+    munmap(image, *size);
+    if (ashmem_set_prot_region(fd, PROT_READ)) {
+        PLOG(ERROR) << "Failed to seal shared memory";
+        return {};
+    }
+    return fd;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--dir DIR] [--manifest FILE] [--max-bytes N] [--check]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string dir = kDefaultDir;
+    std::string manifestPath = kDefaultManifest;
+    size_t maxBytes = kDefaultMaxBytes;
+    bool check = false;
+
+    static const option options[] = {
+            {"dir", required_argument, nullptr, 'd'},
+            {"manifest", required_argument, nullptr, 'm'},
+            {"max-bytes", required_argument, nullptr, 'b'},
+            {"check", no_argument, nullptr, 'c'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:m:b:c", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'd': dir = optarg; break;
+            case 'm': manifestPath = optarg; break;
+            case 'b':
+                if (!ParseUint(optarg, &maxBytes)) {
+                    Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'c': check = true; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    Manifest previous;
+    std::string content, error;
+    if (ReadFileToString(manifestPath, &content) && !ParseManifest(content, &previous, &error)) {
+        LOG(WARNING) << manifestPath << ": " << error << ", ignoring it";
+        previous.clear();
+    }
+
+    CalibCache cache;
+    if (!cache.load(dir, previous, maxBytes, &error)) {
+        LOG(ERROR) << error;
+        return 1;
+    }
+    // A corrupt or skipped file keeps its old record, so it is checked
+    // again on the next start instead of losing its reference.
+    Manifest manifest = cache.manifest();
+    for (const auto& name : cache.corrupt()) manifest[name] = previous[name];
+    for (const auto& name : cache.oversized()) {
+        if (previous.count(name)) manifest[name] = previous[name];
+    }
+    if (!WriteStringToFile(FormatManifest(manifest), manifestPath)) {
+        PLOG(WARNING) << "Failed to write " << manifestPath;
+    }
+
+    size_t size;
+    unique_fd image = CreateImage(cache, &size);
+    if (image < 0) return 1;
+
+    if (check) {
+        // Read everything back the way a client does.
+        CalibCacheClient client;
+        if (!client.attach(image, size, &error)) {
+            LOG(ERROR) << "Image check failed: " << error;
+            return 1;
+        }
+        for (size_t i = 0; i < client.view().count(); i++) {
+            const auto& entry = client.view().entry(i);
+            printf("%08x %10llu %s\n", entry.crc, (unsigned long long)entry.size, entry.name);
+        }
+        for (const auto& name : cache.corrupt()) printf("CORRUPT    %s\n", name.c_str());
+        for (const auto& name : cache.oversized()) printf("OVERSIZED  %s\n", name.c_str());
+        printf("%zu files, image %zu bytes\n", client.view().count(), size);
+        return cache.corrupt().empty() && cache.oversized().empty() ? 0 : 1;
+    }
+
+#ifdef __ANDROID__
+    cache.pin();
+    LOG(INFO) << "Serving " << cache.blobs().size() << " calibration files, " << size << " bytes";
+
+    int sock = android_get_control_socket(vendor::camera::calib::kSocketName);
+    if (sock < 0 || listen(sock, 4)) {
+        PLOG(ERROR) << "No control socket " << vendor::camera::calib::kSocketName;
+        return 1;
+    }
+    while (true) {
+        unique_fd client(accept4(sock, nullptr, nullptr, SOCK_CLOEXEC));
+        if (client < 0) continue;
+        uint64_t imageSize = size;
+        if (SendFileDescriptors(client, &imageSize, sizeof(imageSize), image.get()) < 0) {
+            PLOG(WARNING) << "Failed to send image";
+        }
+    }
+#else
+    Usage(argv[0]);
+    return 1;
+#endif
+}
@@ -12,14 +12,19 @@
 #include <hardware/fingerprint.h>
 #include <hardware/hardware.h>
 #include "BiometricsFingerprint.h"
+#include "FodUi.h"
+#include "UdfpsDim.h"
 #include "xiaomi_fingerprint.h"
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/properties.h>
-#include <fcntl.h>
+#include <errno.h>
 #include <inttypes.h>
-#include <poll.h>
+#include <time.h>
 #include <unistd.h>
+#include <algorithm>
+#include <sstream>
 #include <thread>
 
 #include <android/binder_manager.h>
@@ -40,25 +45,17 @@ namespace implementation {
 #define PARAM_NIT_FOD 1
 #define PARAM_NIT_NONE 0
 
-#define FOD_UI_PATH "/sys/devices/platform/soc/soc:qcom,dsi-display-primary/fod_ui"
-
-static bool readBool(int fd) {
-    char c;
-    int rc;
-
-    rc = lseek(fd, 0, SEEK_SET);
-    if (rc) {
-        LOG(ERROR) << "failed to seek fd, err: " << rc;
-        return false;
-    }
+// Answered here and never passed to the vendor HAL: returns the UDFPS
+// dim layer alpha for the backlight level in param.
+#define COMMAND_DIM_ALPHA 0x1000
 
-    rc = read(fd, &c, sizeof(char));
-    if (rc != 1) {
-        LOG(ERROR) << "failed to read bool from fd, err: " << rc;
-        return false;
-    }
+#define FOD_UI_PATH "/sys/devices/platform/soc/soc:qcom,dsi-display-primary/fod_ui"
+#define VSYNC_EVENT_PATH "/sys/devices/platform/soc/ae00000.qcom,mdss_mdp/drm/card0/sde-crtc-0/vsync_event"
 
-    return c != '0';
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
 // Supported fingerprint HAL version
@@ -102,28 +99,20 @@ BiometricsFingerprint::BiometricsFingerprint() : mClientCallback(nullptr), mDevi
     }
 
     if (mFod) {
+        mVsync = std::make_unique<SysfsVsyncSource>(VSYNC_EVENT_PATH);
+        mHbmScheduler = std::make_unique<FodHbmScheduler>(*mVsync);
         std::thread([this]() {
-            int fd = open(FOD_UI_PATH, O_RDONLY);
-            if (fd < 0) {
-                LOG(ERROR) << "failed to open fd, err: " << fd;
-                return;
-            }
-
-            struct pollfd fodUiPoll = {
-                    .fd = fd,
-                    .events = POLLERR | POLLPRI,
-                    .revents = 0,
-            };
-
-            while (true) {
-                int rc = poll(&fodUiPoll, 1, -1);
-                if (rc < 0) {
-                    LOG(ERROR) << "failed to poll fd, err: " << rc;
-                    continue;
+            SysfsFodUiSource source(FOD_UI_PATH);
+            FodUiWatcher watcher([this](bool pressed, int64_t timeNs) {
+                int64_t at = mHbmScheduler->switchTime(std::max(timeNs, nowNs()));
+                timespec ts = {.tv_sec = at / 1000000000, .tv_nsec = at % 1000000000};
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
                 }
-
-                extCmd(COMMAND_NIT, readBool(fd) ? PARAM_NIT_FOD : PARAM_NIT_NONE);
-            }
+                extCmd(COMMAND_NIT, pressed ? PARAM_NIT_FOD : PARAM_NIT_NONE);
+                mHbmScheduler->record(nowNs());
+            });
+            watcher.run(source);
+            LOG(ERROR) << "fod_ui watcher stopped";
         }).detach();
 
         SetProperty("ro.hardware.fp.fod", "true");
@@ -402,9 +391,22 @@ Return<void> BiometricsFingerprint::onFingerUp() {
 }
 
 Return<int32_t> BiometricsFingerprint::extCmd(int32_t cmd, int32_t param) {
+    if (cmd == COMMAND_DIM_ALPHA) {
+        return param < 0 ? -EINVAL : getUdfpsDimAlpha(param);
+    }
     return mDevice->extCmd(mDevice, cmd, param);
 }
 
+Return<void> BiometricsFingerprint::debug(const hidl_handle& fd, const hidl_vec<hidl_string>&) {
+    if (fd == nullptr || fd->numFds < 1 || !mHbmScheduler) {
+        return Void();
+    }
+    std::ostringstream out;
+    mHbmScheduler->dump(out);
+    android::base::WriteStringToFd(out.str(), fd->data[0]);
+    return Void();
+}
+
 xiaomi_fingerprint_device_t* BiometricsFingerprint::openHal(const char* class_name) {
     int err;
     const hw_module_t* hw_mdl = nullptr;
@@ -13,6 +13,7 @@
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 #include <vendor/xiaomi/hardware/fingerprintextension/1.0/IXiaomiFingerprint.h>
+#include "FodHbm.h"
 #include "xiaomi_fingerprint.h"
 
 namespace aidl {
@@ -39,6 +40,7 @@ namespace V2_3 {
 namespace implementation {
 
 using ::android::sp;
+using ::android::hardware::hidl_handle;
 using ::android::hardware::hidl_string;
 using ::android::hardware::hidl_vec;
 using ::android::hardware::Return;
@@ -89,6 +91,9 @@ struct BiometricsFingerprint : public IBiometricsFingerprint, public IXiaomiFing
     // follow.
     Return<int32_t> extCmd(int32_t cmd, int32_t param) override;
 
+    // Methods from ::android::hidl::base::V1_0::IBase follow.
+    Return<void> debug(const hidl_handle& fd, const hidl_vec<hidl_string>& args) override;
+
   private:
     static xiaomi_fingerprint_device_t* openHal(const char* class_name);
     int32_t connectPowerHalExt();
@@ -110,6 +115,8 @@ struct BiometricsFingerprint : public IBiometricsFingerprint, public IXiaomiFing
     bool mBoostHintSupportIsChecked;
     std::shared_ptr<aidl::google::hardware::power::extension::pixel::IPowerExt> mPowerHalExtAidl;
     bool mFod;
+    std::unique_ptr<SysfsVsyncSource> mVsync;
+    std::unique_ptr<FodHbmScheduler> mHbmScheduler;
 };
 
 }  // namespace implementation
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.biometrics.fingerprint@2.3-service.xiaomi_raphael"
+
+#include "FodHbm.h"
+
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_3 {
+namespace implementation {
+
+SysfsVsyncSource::SysfsVsyncSource(const std::string& path)
+    : mPath(path), mFd(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+    if (mFd < 0) PLOG(ERROR) << "failed to open " << mPath;
+}
+
+SysfsVsyncSource::~SysfsVsyncSource() {
+    if (mFd >= 0) close(mFd);
+}
+
+bool SysfsVsyncSource::lastVsync(int64_t, int64_t* vsyncNs) {
+    if (mFd < 0) return false;
+    char buf[64];
+    ssize_t len = pread(mFd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) return false;
+    buf[len] = '\0';
+    std::string value(buf);
+    if (value.rfind("VSYNC=", 0) != 0) return false;
+    value = value.substr(6, value.find_first_of("\n", 6) - 6);
+    return base::ParseInt(value, vsyncNs) && *vsyncNs > 0;
+}
+
+FodHbmScheduler::FodHbmScheduler(VsyncSource& vsync) : FodHbmScheduler(vsync, Params()) {}
+
+FodHbmScheduler::FodHbmScheduler(VsyncSource& vsync, const Params& params)
+    : mVsync(vsync), mParams(params), mPeriod(params.defaultPeriodNs) {}
+
+bool FodHbmScheduler::vsyncLocked(int64_t nowNs, int64_t* vsyncNs) {
+    if (!mVsync.lastVsync(nowNs, vsyncNs) || *vsyncNs > nowNs ||
+        nowNs - *vsyncNs > mParams.staleNs) {
+        return false;
+    }
+    // Two vsyncs a frame apart give the period, wider gaps are dropped
+    // frames or a pause.
+    int64_t gap = *vsyncNs - mLastVsync;
+    if (mLastVsync >= 0 && gap > mPeriod / 2 && gap < mPeriod * 3 / 2) mPeriod = gap;
+    mLastVsync = *vsyncNs;
+    return true;
+}
+
+int64_t FodHbmScheduler::switchTime(int64_t nowNs) {
+    std::lock_guard<std::mutex> lock(mLock);
+    int64_t vsync;
+    if (!vsyncLocked(nowNs, &vsync)) {
+        mNoVsync++;
+        return nowNs;
+    }
+    int64_t offset = (nowNs - vsync) % mPeriod;
+    if (offset <= mParams.windowNs) {
+        mImmediate++;
+        return nowNs;
+    }
+    mDelayed++;
+    return nowNs - offset + mPeriod + mParams.guardNs;
+}
+
+void FodHbmScheduler::record(int64_t timeNs) {
+    std::lock_guard<std::mutex> lock(mLock);
+    int64_t vsync;
+    if (!vsyncLocked(timeNs, &vsync)) {
+        mUnknownOffsets++;
+        return;
+    }
+    int64_t ms = ((timeNs - vsync) % mPeriod) / 1000000;
+    mOffsets[ms < kBuckets - 1 ? ms : kBuckets - 1]++;
+}
+
+void FodHbmScheduler::dump(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(mLock);
+    os << "FOD HBM switches: " << mImmediate << " immediate, " << mDelayed
+       << " delayed to the next vsync, " << mNoVsync << " without vsync\n";
+    os << "vsync period: " << mPeriod << " ns\n";
+    os << "switch offset from vsync:\n";
+    for (int i = 0; i < kBuckets; i++) {
+        if (!mOffsets[i]) continue;
+        os << "  " << (i == kBuckets - 1 ? ">=" : "") << i << " ms: " << mOffsets[i] << "\n";
+    }
+    if (mUnknownOffsets) os << "  unknown: " << mUnknownOffsets << "\n";
+}
+
+}  // namespace implementation
+}  // namespace V2_3
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
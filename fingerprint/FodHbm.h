@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_3 {
+namespace implementation {
+
+// Latest vsync of the primary display: the crtc's vsync_event on the
+// device, a simulated clock on the host.
+class VsyncSource {
+  public:
+    virtual ~VsyncSource() = default;
+
+    // CLOCK_MONOTONIC time of the last vsync at or before nowNs.
+    virtual bool lastVsync(int64_t nowNs, int64_t* vsyncNs) = 0;
+};
+
+// Reads "VSYNC=<ns>", updated while SurfaceFlinger has vsync enabled.
+class SysfsVsyncSource : public VsyncSource {
+  public:
+    explicit SysfsVsyncSource(const std::string& path);
+    ~SysfsVsyncSource() override;
+
+    bool lastVsync(int64_t nowNs, int64_t* vsyncNs) override;
+
+  private:
+    std::string mPath;
+    int mFd;
+};
+
+// Decides when the HBM switch for a fod_ui change goes out. The panel
+// applies a brightness command at the next frame start, so one sent
+// late in a frame is applied halfway through the scan or misses the
+// frame; sending it just after a vsync makes the next frame the first
+// one fully lit. Keeps a histogram of where in the frame switches
+// actually went out.
+class FodHbmScheduler {
+  public:
+    struct Params {
+        // Until two vsyncs in a row were seen; the panel runs at 60 Hz.
+        int64_t defaultPeriodNs = 16666667;
+        // Switch right away this early in a frame.
+        int64_t windowNs = 2000000;
+        // Aim this far past the vsync to stay clear of it.
+        int64_t guardNs = 500000;
+        // An older vsync means SurfaceFlinger turned vsync off because
+        // nothing is drawn, so there is no frame to tear.
+        int64_t staleNs = 100000000;
+    };
+
+    static constexpr int kBuckets = 17;
+
+    explicit FodHbmScheduler(VsyncSource& vsync);
+    FodHbmScheduler(VsyncSource& vsync, const Params& params);
+
+    // When to send the switch for a change seen at nowNs, >= nowNs.
+    int64_t switchTime(int64_t nowNs);
+    // Records a switch sent at timeNs.
+    void record(int64_t timeNs);
+
+    void dump(std::ostream& os);
+
+  private:
+    bool vsyncLocked(int64_t nowNs, int64_t* vsyncNs);
+
+    VsyncSource& mVsync;
+    const Params mParams;
+    std::mutex mLock;
+    int64_t mLastVsync = -1;
+    int64_t mPeriod;
+
+    uint64_t mImmediate = 0;
+    uint64_t mDelayed = 0;
+    uint64_t mNoVsync = 0;
+    // Offset from the vsync before each switch, in ms; the last bucket
+    // takes everything later.
+    uint64_t mOffsets[kBuckets] = {};
+    uint64_t mUnknownOffsets = 0;
+};
+
+}  // namespace implementation
+}  // namespace V2_3
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
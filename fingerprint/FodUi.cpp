@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "android.hardware.biometrics.fingerprint@2.3-service.xiaomi_raphael"
+
+#include "FodUi.h"
+
+#include <android-base/logging.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_3 {
+namespace implementation {
+
+SysfsFodUiSource::SysfsFodUiSource(const std::string& path)
+    : mPath(path), mFd(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+    if (mFd < 0) PLOG(ERROR) << "failed to open " << mPath;
+}
+
+SysfsFodUiSource::~SysfsFodUiSource() {
+    if (mFd >= 0) close(mFd);
+}
+
+bool SysfsFodUiSource::wait(bool* pressed, int64_t* timeNs) {
+    if (mFd < 0) return false;
+
+    struct pollfd fodUiPoll = {
+            .fd = mFd,
+            .events = POLLERR | POLLPRI,
+            .revents = 0,
+    };
+    // A failed poll or read is logged and waited out, giving up would
+    // leave HBM dead until the HAL restarts.
+    while (true) {
+        if (poll(&fodUiPoll, 1, -1) < 0) {
+            if (errno != EINTR) PLOG(ERROR) << "failed to poll " << mPath;
+            continue;
+        }
+
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        *timeNs = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+        char c;
+        if (pread(mFd, &c, sizeof(c), 0) != 1) {
+            PLOG(ERROR) << "failed to read " << mPath;
+            continue;
+        }
+        *pressed = c != '0';
+        return true;
+    }
+}
+
+FodUiWatcher::FodUiWatcher(Switch onSwitch) : mSwitch(std::move(onSwitch)) {}
+
+void FodUiWatcher::run(FodUiSource& source) {
+    bool pressed;
+    int64_t timeNs;
+    while (source.wait(&pressed, &timeNs)) onNotify(pressed, timeNs);
+}
+
+void FodUiWatcher::onNotify(bool pressed, int64_t timeNs) {
+    mNotifications++;
+    if (mKnown && pressed == mPressed) return;
+    mKnown = true;
+    mPressed = pressed;
+    mSwitches++;
+    mSwitch(pressed, timeNs);
+}
+
+}  // namespace implementation
+}  // namespace V2_3
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace android {
+namespace hardware {
+namespace biometrics {
+namespace fingerprint {
+namespace V2_3 {
+namespace implementation {
+
+// Where fod_ui changes come from: the panel driver's sysfs node on the
+// device, a script on the host.
+class FodUiSource {
+  public:
+    virtual ~FodUiSource() = default;
+
+    // Blocks until fod_ui is notified and returns its value and the
+    // CLOCK_MONOTONIC time of the notification. False once the source
+    // is exhausted, or could not be opened at all.
+    virtual bool wait(bool* pressed, int64_t* timeNs) = 0;
+};
+
+// sysfs_notify() based source, wakes up on POLLPRI.
+class SysfsFodUiSource : public FodUiSource {
+  public:
+    explicit SysfsFodUiSource(const std::string& path);
+    ~SysfsFodUiSource() override;
+
+    bool wait(bool* pressed, int64_t* timeNs) override;
+
+  private:
+    std::string mPath;
+    int mFd;
+};
+
+// Turns fod_ui notifications into HBM switches. The panel driver
+// notifies on every touch report while the finger is down, only
+// actual changes are passed on so the vendor HAL is not called again
+// with the state it is already in.
+class FodUiWatcher {
+  public:
+    using Switch = std::function<void(bool pressed, int64_t timeNs)>;
+
+    explicit FodUiWatcher(Switch onSwitch);
+
+    // Consumes the source until it is exhausted.
+    void run(FodUiSource& source);
+    void onNotify(bool pressed, int64_t timeNs);
+
+    uint64_t notifications() const { return mNotifications; }
+    uint64_t switches() const { return mSwitches; }
+
+  private:
+    Switch mSwitch;
+    bool mKnown = false;
+    bool mPressed = false;
+    uint64_t mNotifications = 0;
+    uint64_t mSwitches = 0;
+};
+
+}  // namespace implementation
+}  // namespace V2_3
+}  // namespace fingerprint
+}  // namespace biometrics
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,14 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "UdfpsDim.h"
+
+#include "UdfpsDimTable.h"
+
+uint8_t getUdfpsDimAlpha(uint32_t backlight) {
+    constexpr uint32_t kMax = sizeof(kUdfpsDimAlpha) - 1;
+    return kUdfpsDimAlpha[backlight < kMax ? backlight : kMax];
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// Alpha (0-255) of the black layer that brings the HBM lit screen back
+// to the brightness of backlight level (0-255), see udfps_dim.py.
+uint8_t getUdfpsDimAlpha(uint32_t backlight);
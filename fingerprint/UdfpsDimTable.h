@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Generated by udfps_dim.py from config_screenBrightnessNits, HBM at
+// 600 nits. Do not edit.
+
+#pragma once
+
+#include <cstdint>
+
+static constexpr float kUdfpsHbmNits = 600;
+
+static constexpr uint8_t kUdfpsDimAlpha[256] = {
+        255, 235, 230, 225, 221, 218, 215, 212, 209, 207, 205, 203, 201, 199, 197, 195,
+        193, 191, 190, 188, 187, 185, 184, 182, 181, 179, 178, 177, 175, 174, 173, 172,
+        170, 169, 168, 167, 166, 165, 164, 162, 161, 160, 159, 158, 157, 156, 155, 154,
+        153, 152, 152, 151, 150, 149, 148, 147, 146, 145, 144, 143, 143, 142, 141, 140,
+        139, 138, 138, 137, 136, 135, 134, 134, 133, 132, 131, 131, 130, 129, 128, 128,
+        127, 126, 126, 125, 124, 123, 123, 122, 121, 120, 120, 119, 118, 118, 117, 116,
+        116, 115, 114, 114, 113, 113, 112, 111, 111, 110, 109, 109, 108, 108, 107, 106,
+        106, 105, 105, 104, 103, 103, 102, 102, 101, 100, 100,  99,  99,  98,  98,  97,
+         96,  96,  95,  95,  94,  94,  93,  93,  92,  91,  91,  90,  90,  89,  89,  88,
+         88,  87,  87,  86,  86,  85,  85,  84,  84,  83,  83,  82,  82,  81,  81,  80,
+         80,  79,  79,  78,  78,  77,  77,  76,  76,  75,  75,  74,  74,  73,  73,  72,
+         72,  71,  71,  70,  70,  69,  69,  68,  68,  67,  67,  67,  66,  66,  65,  65,
+         64,  64,  63,  63,  63,  62,  62,  61,  61,  60,  60,  59,  59,  59,  58,  58,
+         57,  57,  56,  56,  56,  55,  55,  54,  54,  53,  53,  53,  52,  52,  51,  51,
+         51,  50,  50,  49,  49,  48,  48,  48,  47,  47,  46,  46,  46,  45,  45,  44,
+         44,  44,  43,  43,  42,  42,  42,  41,  41,  40,  40,  40,  39,  39,  39,  38,
+};
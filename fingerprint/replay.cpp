@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "fod_ui_replay"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+
+#include "FodHbm.h"
+#include "FodUi.h"
+
+using android::base::ParseInt;
+using android::base::ParseUint;
+using android::base::Split;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodHbmScheduler;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodUiSource;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodUiWatcher;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::VsyncSource;
+
+namespace {
+
+struct Notify {
+    int64_t timeNs;
+    bool pressed;
+};
+
+// Replays a script of fod_ui notifications:
+//   <ms> <0|1>
+class ScriptFodUiSource : public FodUiSource {
+  public:
+    explicit ScriptFodUiSource(const std::vector<Notify>& script) : mScript(script) {}
+
+    bool wait(bool* pressed, int64_t* timeNs) override {
+        if (mNext == mScript.size()) return false;
+        *pressed = mScript[mNext].pressed;
+        *timeNs = mScript[mNext].timeNs;
+        mNext++;
+        return true;
+    }
+
+  private:
+    const std::vector<Notify>& mScript;
+    size_t mNext = 0;
+};
+
+// A display that has vsync on throughout, at a fixed period and phase.
+class SimVsyncSource : public VsyncSource {
+  public:
+    SimVsyncSource(int64_t periodNs, int64_t phaseNs) : mPeriod(periodNs), mPhase(phaseNs) {}
+
+    bool lastVsync(int64_t nowNs, int64_t* vsyncNs) override {
+        if (nowNs < mPhase) return false;
+        *vsyncNs = nowNs - (nowNs - mPhase) % mPeriod;
+        return true;
+    }
+
+  private:
+    int64_t mPeriod;
+    int64_t mPhase;
+};
+
+bool Load(std::istream& in, std::vector<Notify>* script) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, value;
+        if (!(fields >> time)) continue;
+        int64_t ms;
+        if (!ParseInt(time, &ms) || !(fields >> value) || (value != "0" && value != "1")) {
+            LOG(ERROR) << "script line " << lineno << ": malformed notification";
+            return false;
+        }
+        script->push_back({ms * 1000000, value == "1"});
+    }
+    return true;
+}
+
+int64_t Now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// PERIOD_US[,PHASE_US]
+bool ParseVsync(const std::string& arg, int64_t* periodNs, int64_t* phaseNs) {
+    auto fields = Split(arg, ",");
+    int64_t period, phase = 0;
+    if (fields.size() > 2 || !ParseInt(fields[0], &period, int64_t(1)) ||
+        (fields.size() == 2 && !ParseInt(fields[1], &phase, int64_t(0)))) {
+        return false;
+    }
+    *periodNs = period * 1000;
+    *phaseNs = phase * 1000;
+    return true;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--bench ROUNDS] [--vsync PERIOD_US[,PHASE_US]] --script FILE\n",
+            name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string scriptPath;
+    unsigned rounds = 0;
+    int64_t vsyncPeriod = 0, vsyncPhase = 0;
+
+    static const option options[] = {
+            {"bench", required_argument, nullptr, 'b'},
+            {"script", required_argument, nullptr, 's'},
+            {"vsync", required_argument, nullptr, 'v'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:s:v:", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'b':
+                if (!ParseUint(optarg, &rounds) || rounds == 0) {
+                    Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's': scriptPath = optarg; break;
+            case 'v':
+                if (!ParseVsync(optarg, &vsyncPeriod, &vsyncPhase)) {
+                    Usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+    if (scriptPath.empty()) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(scriptPath);
+    if (!in) {
+        PLOG(ERROR) << "Failed to open " << scriptPath;
+        return 1;
+    }
+    std::vector<Notify> script;
+    if (!Load(in, &script)) return 1;
+
+    if (rounds) {
+        // The HAL call is replaced by a counter, so this is the cost of
+        // the watcher itself per notification.
+        uint64_t calls = 0;
+        int64_t start = Now();
+        for (unsigned i = 0; i < rounds; i++) {
+            FodUiWatcher watcher([&](bool, int64_t) { calls++; });
+            ScriptFodUiSource source(script);
+            watcher.run(source);
+        }
+        int64_t elapsed = Now() - start;
+        uint64_t notifications = uint64_t(rounds) * script.size();
+        printf("%" PRIu64 " notifications, %" PRIu64 " switches, %.1f ns/notification\n",
+               notifications, calls, notifications ? double(elapsed) / notifications : 0.0);
+        return 0;
+    }
+
+    if (!vsyncPeriod) {
+        FodUiWatcher watcher([](bool pressed, int64_t timeNs) {
+            std::cout << timeNs / 1000000 << " set nit " << (pressed ? "fod" : "none") << "\n";
+        });
+        ScriptFodUiSource source(script);
+        watcher.run(source);
+        std::cout << watcher.notifications() << " notifications, " << watcher.switches()
+                  << " switches\n";
+        return 0;
+    }
+
+    // The switch is taken to go out exactly when scheduled.
+    SimVsyncSource vsync(vsyncPeriod, vsyncPhase);
+    FodHbmScheduler scheduler(vsync);
+    FodUiWatcher watcher([&](bool pressed, int64_t timeNs) {
+        int64_t at = scheduler.switchTime(timeNs);
+        scheduler.record(at);
+        printf("%" PRId64 " set nit %s at %.3f ms (+%.3f)\n", timeNs / 1000000,
+               pressed ? "fod" : "none", at / 1e6, (at - timeNs) / 1e6);
+    });
+    ScriptFodUiSource source(script);
+    watcher.run(source);
+    scheduler.dump(std::cout);
+    return 0;
+}
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Build the UDFPS dim layer alpha table from the panel's brightness curve.
+
+  udfps_dim.py generate [--config XML] [--hbm-nits NITS] -o HEADER
+  udfps_dim.py check [--config XML] [--hbm-nits NITS] HEADER
+
+While the sensor is lit the panel runs at HBM and a black layer over
+the rest of the screen brings it back to the brightness the user had.
+Alpha blending scales the encoded value, so the light that gets through
+is (1 - alpha) ^ 2.2 of HBM, and the alpha for a backlight level with
+brightness L is 1 - (L / HBM) ^ (1 / 2.2).
+
+L comes from config_screenBrightnessBacklight and
+config_screenBrightnessNits in the framework overlay, linearly
+interpolated between the measured levels. That curve stops at the
+brightest sustainable level (420 nits) and leaves HBM out, so HBM
+defaults to the panel's 600 nit rated peak, which the FOD HBM command
+drives it to. Pass --hbm-nits with a measured value to override it.
+
+generate writes UdfpsDimTable.h with one alpha per backlight level.
+check regenerates the table and fails if the header differs, the alpha
+ever increases with the backlight or an entry is further than half a
+step from the exact alpha.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+GAMMA = 2.2
+LEVELS = 256
+HBM_NITS = 600.0
+
+HEADER = '''/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Generated by udfps_dim.py from config_screenBrightnessNits, HBM at
+// %(hbm)s nits. Do not edit.
+
+#pragma once
+
+#include <cstdint>
+
+static constexpr float kUdfpsHbmNits = %(hbm)s;
+
+static constexpr uint8_t kUdfpsDimAlpha[%(levels)d] = {
+%(rows)s
+};
+'''
+
+
+def read_array(xml, name):
+    match = re.search(r'<(?:integer-)?array name="%s"[^>]*>(.*?)</(?:integer-)?array>' % name,
+                      xml, re.S)
+    if not match:
+        sys.exit('%s not found' % name)
+    body = re.sub(r'<!--.*?-->', '', match.group(1), flags=re.S)
+    return [float(item) for item in re.findall(r'<item>\s*([^<\s]+)\s*</item>', body)]
+
+
+def load_curve(path):
+    with open(path, 'r') as f:
+        xml = f.read()
+    levels = read_array(xml, 'config_screenBrightnessBacklight')
+    nits = read_array(xml, 'config_screenBrightnessNits')
+    if len(levels) != len(nits) or len(levels) < 2:
+        sys.exit('%s: backlight and nits arrays differ in size' % path)
+    points = sorted(zip(levels, nits))
+    for (l0, n0), (l1, n1) in zip(points, points[1:]):
+        if l1 == l0 or n1 < n0:
+            sys.exit('%s: brightness curve not increasing at backlight %d' % (path, l1))
+    return points
+
+
+def nits_at(points, level):
+    if level <= points[0][0]:
+        return points[0][1] * level / points[0][0] if points[0][0] else points[0][1]
+    for (l0, n0), (l1, n1) in zip(points, points[1:]):
+        if level <= l1:
+            return n0 + (n1 - n0) * (level - l0) / (l1 - l0)
+    return points[-1][1]
+
+
+def exact_alpha(points, hbm, level):
+    ratio = min(nits_at(points, level) / hbm, 1.0)
+    return (1 - ratio ** (1 / GAMMA)) * 255
+
+
+def build(points, hbm):
+    return [int(round(exact_alpha(points, hbm, level))) for level in range(LEVELS)]
+
+
+def render(table, hbm):
+    rows = []
+    for i in range(0, len(table), 16):
+        rows.append('        ' + ', '.join('%3d' % a for a in table[i:i + 16]) + ',')
+    return HEADER % {'hbm': '%g' % hbm, 'levels': len(table), 'rows': '\n'.join(rows)}
+
+
+def parse_header(path):
+    with open(path, 'r') as f:
+        text = f.read()
+    body = text[text.index('{') + 1:text.index('}')]
+    return [int(v) for v in re.findall(r'\d+', body)]
+
+
+def check(points, hbm, table, header):
+    errors = []
+    if header != table:
+        errors.append('header is out of date, run generate')
+    for level in range(1, len(header)):
+        if header[level] > header[level - 1]:
+            errors.append('alpha rises from %d to %d at backlight %d' %
+                          (header[level - 1], header[level], level))
+    worst = (0, 0)
+    for level, alpha in enumerate(header):
+        error = abs(alpha - exact_alpha(points, hbm, level))
+        worst = max(worst, (error, level))
+    if worst[0] > 0.5 + 1e-9:
+        errors.append('alpha at backlight %d is %.2f off' % (worst[1], worst[0]))
+    print('%d levels, max error %.3f at backlight %d' % (len(header), worst[0], worst[1]))
+    for error in errors:
+        print('error: ' + error, file=sys.stderr)
+    return 1 if errors else 0
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    default_config = os.path.join(here, '..', 'overlay', 'frameworks', 'base', 'core', 'res',
+                                  'res', 'values', 'config.xml')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = parser.add_subparsers(dest='command', required=True)
+    for name in ('generate', 'check'):
+        command = sub.add_parser(name)
+        command.add_argument('--config', default=default_config)
+        command.add_argument('--hbm-nits', type=float)
+    sub.choices['generate'].add_argument('-o', '--output', required=True)
+    sub.choices['check'].add_argument('header')
+    args = parser.parse_args()
+
+    points = load_curve(args.config)
+    hbm = args.hbm_nits or HBM_NITS
+    table = build(points, hbm)
+
+    if args.command == 'generate':
+        with open(args.output, 'w') as f:
+            f.write(render(table, hbm))
+        return 0
+    return check(points, hbm, table, parse_header(args.header))
+
+
+if __name__ == '__main__':
+    sys.exit(main())
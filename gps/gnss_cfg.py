@@ -0,0 +1,447 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Validate, generate and compare the GNSS configuration files.
+
+  gnss_cfg.py check [--conf-dir DIR]
+  gnss_cfg.py generate [--conf-dir DIR] --profile FILE -o OUT_DIR
+  gnss_cfg.py replay [--hdop LIMIT] LOG [LOG...]
+
+check validates every file against gnss.schema and cross-checks the
+features that span several files. generate applies a profile (see
+profiles/) on top of the checked-in files and validates the result.
+replay reads recorded NMEA logs and prints the fix timeline of each so
+profiles can be compared on time-to-first-fix. Sentences too short or
+malformed to read are skipped, and UTC times carry over midnight. See
+scripts/ for a sample log.
+"""
+
+import argparse
+import os
+import sys
+
+CONF_FILES = [
+    'gps.conf',
+    'izat.conf',
+    'flp.conf',
+    'sap.conf',
+    'apdr.conf',
+    'lowi.conf',
+    'xtwifi.conf',
+]
+
+# gps.conf SUPL_MODE bits and the CAPABILITIES bits they need
+SUPL_MODE_MSB = 0x1
+SUPL_MODE_MSA = 0x2
+CAPABILITY_MSB = 0x02
+CAPABILITY_MSA = 0x04
+
+NLP_MODE_OSNLP_ONLY = 1
+
+
+class Key:
+    def __init__(self, name, kind, args, flags):
+        self.name = name
+        self.kind = kind
+        self.args = args
+        self.block = 'block' in flags
+
+    def check(self, value):
+        """Returns an error string, or None if value is acceptable."""
+        if self.kind == 'str':
+            return None
+        if self.kind == 'enum':
+            choices = self.args[0].split('|')
+            if value not in choices:
+                return 'expected one of %s' % ', '.join(choices)
+            return None
+        try:
+            if self.kind == 'float':
+                number = float(value)
+                lo, hi = float(self.args[0]), float(self.args[1])
+            else:
+                number = int(value, 0)
+                lo, hi = int(self.args[0], 0), int(self.args[1], 0)
+        except ValueError:
+            return 'expected %s value' % self.kind
+        if not lo <= number <= hi:
+            return 'out of range [%s, %s]' % (self.args[0], self.args[1])
+        return None
+
+
+def load_schema(path):
+    schema = {}
+    current = None
+    with open(path, 'r') as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            if line.startswith('['):
+                current = schema.setdefault(line.strip('[]'), {})
+                continue
+            fields = line.split()
+            name, kind = fields[0], fields[1]
+            nargs = {'int': 2, 'hex': 2, 'float': 2, 'enum': 1}.get(kind, 0)
+            current[name] = Key(name, kind, fields[2:2 + nargs], fields[2 + nargs:])
+    return schema
+
+
+class Conf:
+    """One configuration file, kept line by line so it can be rewritten."""
+
+    def __init__(self, name, lines):
+        self.name = name
+        self.lines = lines
+        # (lineno, key, value, block) where block is the name of the
+        # enclosing repeated block, or None for global keys.
+        self.entries = []
+
+    @classmethod
+    def load(cls, path, spec):
+        with open(path, 'r') as f:
+            conf = cls(os.path.basename(path), f.read().splitlines())
+        conf.parse(spec)
+        return conf
+
+    def parse(self, spec):
+        self.entries = []
+        block = None
+        for lineno, line in enumerate(self.lines, 1):
+            stripped = line.strip()
+            if not stripped or stripped.startswith('#'):
+                continue
+            if '=' not in stripped:
+                self.entries.append((lineno, None, stripped, block))
+                continue
+            key, value = [part.strip() for part in stripped.split('=', 1)]
+            if key in spec and spec[key].block:
+                block = '%s:%d' % (value, lineno)
+            self.entries.append((lineno, key, value, block))
+
+    def get(self, key, default=None):
+        for _, k, value, block in self.entries:
+            if k == key and block is None:
+                return value
+        return default
+
+    def blocks(self, key):
+        """Returns {block value: {key: value}} for blocks started by key."""
+        result = {}
+        current = None
+        for _, k, value, block in self.entries:
+            if k == key:
+                current = result.setdefault(value, {})
+            if block is not None and current is not None:
+                current[k] = value
+        return result
+
+    def set(self, key, value, block_name=None):
+        for index, (lineno, k, _, block) in enumerate(self.entries):
+            if k != key:
+                continue
+            if block_name is None and block is not None:
+                continue
+            if block_name is not None and (block is None or
+                                           block.rsplit(':', 1)[0] != block_name):
+                continue
+            old = self.lines[lineno - 1]
+            separator = ' = ' if ' = ' in old else '='
+            self.lines[lineno - 1] = '%s%s%s' % (key, separator, value)
+            self.entries[index] = (lineno, key, value, block)
+            return True
+        return False
+
+    def text(self):
+        return '\n'.join(self.lines) + '\n'
+
+
+class Report:
+    def __init__(self):
+        self.errors = []
+        self.warnings = []
+
+    def error(self, message):
+        self.errors.append(message)
+
+    def warning(self, message):
+        self.warnings.append(message)
+
+    def dump(self):
+        for message in self.warnings:
+            print('warning: ' + message, file=sys.stderr)
+        for message in self.errors:
+            print('error: ' + message, file=sys.stderr)
+
+
+def check_file(conf, spec, report):
+    seen = {}
+    for lineno, key, value, block in conf.entries:
+        where = '%s:%d' % (conf.name, lineno)
+        if key is None:
+            report.error('%s: not a key=value line: %s' % (where, value))
+            continue
+        if (key, block) in seen:
+            report.error('%s: duplicate key %s (first set on line %d)' %
+                         (where, key, seen[(key, block)]))
+        seen[(key, block)] = lineno
+        if key not in spec:
+            report.error('%s: unknown key %s' % (where, key))
+            continue
+        problem = spec[key].check(value)
+        if problem:
+            report.error('%s: %s=%s: %s' % (where, key, value, problem))
+
+
+def process_enabled(processes, name):
+    return processes.get(name, {}).get('PROCESS_STATE') == 'ENABLED'
+
+
+def check_cross(confs, report):
+    gps = confs['gps.conf']
+    izat = confs['izat.conf']
+    processes = izat.blocks('PROCESS_NAME')
+
+    supl_mode = int(gps.get('SUPL_MODE', '0'), 0)
+    capabilities = int(gps.get('CAPABILITIES', '0'), 0)
+    if supl_mode & SUPL_MODE_MSB and not capabilities & CAPABILITY_MSB:
+        report.error('gps.conf: SUPL_MODE enables MS-Based but CAPABILITIES lacks MSB')
+    if supl_mode & SUPL_MODE_MSA and not capabilities & CAPABILITY_MSA:
+        report.error('gps.conf: SUPL_MODE enables MS-Assisted but CAPABILITIES lacks MSA')
+
+    xtra_used = gps.get('XTRA_SYSTEM_TIME_INJECT', '0') != '0' or \
+        gps.get('XTRA_SERVER_1') is not None
+    if xtra_used and not process_enabled(processes, 'xtra-daemon'):
+        report.error('gps.conf configures XTRA but xtra-daemon is disabled in izat.conf')
+    if process_enabled(processes, 'xtra-daemon') and gps.get('NTP_SERVER') is None:
+        report.warning('xtra-daemon is enabled but gps.conf sets no NTP_SERVER')
+
+    nlp_mode = int(izat.get('NLP_MODE', '1'))
+    qnp_processes = ['xtwifi-client', 'xtwifi-inet-agent']
+    if nlp_mode != NLP_MODE_OSNLP_ONLY:
+        for name in qnp_processes:
+            if not process_enabled(processes, name):
+                report.error('izat.conf: NLP_MODE=%d needs QNP but %s is disabled' %
+                             (nlp_mode, name))
+        if confs['xtwifi.conf'].get('XT_SERVER_ROOT_URL') is None:
+            report.error('izat.conf: NLP_MODE=%d needs QNP but xtwifi.conf has no '
+                         'XT_SERVER_ROOT_URL' % nlp_mode)
+    elif any(process_enabled(processes, name) for name in qnp_processes):
+        report.warning('izat.conf: NLP_MODE=1 (OSNLP only) but QNP processes are '
+                       'still launched')
+
+    wifi_features = [key for key in ['FREE_WIFI_SCAN_INJECT', 'SUPL_WIFI',
+                                     'WIFI_SUPPLICANT_INFO']
+                     if izat.get(key, 'DISABLED') != 'DISABLED']
+    if wifi_features and not process_enabled(processes, 'lowi-server'):
+        report.error('izat.conf: %s need lowi-server, which is disabled' %
+                     ', '.join(wifi_features))
+
+    if confs['flp.conf'].get('ALLOW_NETWORK_FIXES', '0') != '0' and nlp_mode == 0:
+        report.error('flp.conf allows network fixes but izat.conf disables NLP')
+
+    if izat.get('SAP', 'DISABLED') == 'DISABLED' and \
+            process_enabled(processes, 'slim_daemon'):
+        report.warning('izat.conf: slim_daemon is launched but SAP is disabled')
+
+
+def load_confs(conf_dir, schema):
+    return {name: Conf.load(os.path.join(conf_dir, name), schema.get(name, {}))
+            for name in CONF_FILES}
+
+
+def check(confs, schema):
+    report = Report()
+    for name, conf in confs.items():
+        check_file(conf, schema.get(name, {}), report)
+    check_cross(confs, report)
+    return report
+
+
+def apply_profile(confs, schema, path):
+    """Applies a profile made of [file] or [file process NAME] sections."""
+    section = None
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            where = '%s:%d' % (path, lineno)
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            if line.startswith('['):
+                fields = line.strip('[]').split()
+                if fields[0] not in confs:
+                    sys.exit('%s: unknown file %s' % (where, fields[0]))
+                section = (fields[0], fields[2] if len(fields) == 3 else None)
+                continue
+            if section is None or '=' not in line:
+                sys.exit('%s: expected key=value inside a [file] section' % where)
+            key, value = [part.strip() for part in line.split('=', 1)]
+            name, block = section
+            spec = schema.get(name, {}).get(key)
+            if spec is None:
+                sys.exit('%s: unknown %s key %s' % (where, name, key))
+            problem = spec.check(value)
+            if problem:
+                sys.exit('%s: %s=%s: %s' % (where, key, value, problem))
+            if not confs[name].set(key, value, block):
+                sys.exit('%s: %s not present in %s%s' %
+                         (where, key, name, ' process %s' % block if block else ''))
+
+
+def nmea_fields(sentence):
+    """Returns the fields of a checksummed NMEA sentence, or None."""
+    if not sentence.startswith('$') or '*' not in sentence:
+        return None
+    body, checksum = sentence[1:].rsplit('*', 1)
+    computed = 0
+    for char in body:
+        computed ^= ord(char)
+    try:
+        if computed != int(checksum[:2], 16):
+            return None
+    except ValueError:
+        return None
+    return body.split(',')
+
+
+# Fields replay reads from each sentence, counting the talker and type
+MIN_FIELDS = {
+    'GGA': 9,
+    'GSA': 3,
+    'GSV': 8,
+    'RMC': 3,
+}
+
+SECONDS_PER_DAY = 24 * 3600
+
+
+def utc_seconds(field):
+    if len(field) < 6:
+        return None
+    try:
+        return int(field[0:2]) * 3600 + int(field[2:4]) * 60 + float(field[4:])
+    except ValueError:
+        return None
+
+
+def replay(path, hdop_limit):
+    """Returns an ordered list of (event, seconds since first sentence)."""
+    events = {}
+    order = []
+    start = None
+    last = None
+    # Added to UTC times once the log has crossed midnight
+    day_offset = 0
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            index = line.find('$')
+            if index < 0:
+                continue
+            fields = nmea_fields(line[index:])
+            if fields is None or len(fields) < MIN_FIELDS.get(fields[0][2:], 1):
+                continue
+
+            # Prefer a host timestamp prefix, fall back to the sentence's UTC
+            # time and finally to the last known time.
+            prefix = line[:index].split()
+            now = None
+            if prefix:
+                try:
+                    now = float(prefix[0])
+                except ValueError:
+                    pass
+            kind = fields[0][2:]
+            if now is None and kind in ('GGA', 'RMC') and fields[1]:
+                now = utc_seconds(fields[1])
+                # UTC restarts at 0 at midnight, a backwards step of more
+                # than half a day is the next day.
+                if now is not None and last is not None and \
+                        now + day_offset < last - SECONDS_PER_DAY / 2:
+                    day_offset += SECONDS_PER_DAY
+                if now is not None:
+                    now += day_offset
+            if now is None:
+                now = last
+            if now is None:
+                continue
+            if start is None:
+                start = now
+            last = now
+
+            def mark(event):
+                if event not in events:
+                    events[event] = now - start
+                    order.append(event)
+
+            try:
+                if kind == 'GSV':
+                    snrs = [fields[i] for i in range(7, len(fields), 4)]
+                    if any(snr and int(snr) > 0 for snr in snrs):
+                        mark('first satellite tracked')
+                elif kind == 'GSA' and fields[2] in ('2', '3'):
+                    mark('first %sD fix' % fields[2])
+                elif kind == 'GGA' and fields[6] not in ('', '0'):
+                    mark('first fix (GGA)')
+                    if fields[8] and float(fields[8]) <= hdop_limit:
+                        mark('first fix with HDOP <= %.1f' % hdop_limit)
+                elif kind == 'RMC' and fields[2] == 'A':
+                    mark('first valid RMC')
+            except ValueError:
+                continue
+    return [(event, events[event]) for event in order]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--schema', default=os.path.join(here, 'gnss.schema'))
+    parser.add_argument('--conf-dir', default=os.path.join(here, 'etc'))
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    sub.add_parser('check')
+
+    gen_parser = sub.add_parser('generate')
+    gen_parser.add_argument('--profile', required=True)
+    gen_parser.add_argument('-o', '--output', required=True)
+
+    replay_parser = sub.add_parser('replay')
+    replay_parser.add_argument('--hdop', type=float, default=2.0)
+    replay_parser.add_argument('logs', nargs='+')
+
+    args = parser.parse_args()
+
+    if args.command == 'replay':
+        for path in args.logs:
+            print(path)
+            timeline = replay(path, args.hdop)
+            if not timeline:
+                print('    no fix')
+            for event, seconds in timeline:
+                print('    %8.1fs  %s' % (seconds, event))
+        return 0
+
+    schema = load_schema(args.schema)
+    confs = load_confs(args.conf_dir, schema)
+    if args.command == 'generate':
+        apply_profile(confs, schema, args.profile)
+
+    report = check(confs, schema)
+    report.dump()
+    if report.errors:
+        return 1
+
+    if args.command == 'generate':
+        os.makedirs(args.output, exist_ok=True)
+        for name, conf in confs.items():
+            with open(os.path.join(args.output, name), 'w') as f:
+                f.write(conf.text())
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
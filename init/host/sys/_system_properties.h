@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+// The part of bionic's property area libinit_utils uses. The host build
+// leaves it to the binary linking libinit_xiaomi_msmnile, see
+// tests/fakes/FakeProperties.cpp.
+
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+typedef struct prop_info prop_info;
+
+const prop_info* __system_property_find(const char* name);
+int __system_property_update(prop_info* pi, const char* value, unsigned int len);
+int __system_property_add(const char* name, unsigned int namelen, const char* value,
+                          unsigned int valuelen);
+
+__END_DECLS
@@ -23,6 +23,9 @@ typedef struct variant_info {
     bool nfc;
 } variant_info_t;
 
+const variant_info_t* find_variant(const std::vector<variant_info_t>& variants,
+                                   const std::string& hwc_value, const std::string& sku_value);
+
 void search_variant(const std::vector<variant_info_t> variants);
 
 void set_variant_props(const variant_info_t variant);
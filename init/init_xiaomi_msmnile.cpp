@@ -9,5 +9,7 @@
 #include "vendor_init.h"
 
 void vendor_load_properties() {
+#ifndef __ANDROID_RECOVERY__
     set_dalvik_heap();
+#endif
 }
@@ -4,11 +4,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <android-base/chrono_utils.h>
+#include <android-base/logging.h>
 #include <libinit_dalvik_heap.h>
 #include <libinit_variant.h>
 
 #include "vendor_init.h"
 
+using android::base::Timer;
+
 static const variant_info_t raphaelin_info = {
     .hwc_value = "INDIA",
     .sku_value = "",
@@ -55,6 +59,12 @@ static const std::vector<variant_info_t> variants = {
 };
 
 void vendor_load_properties() {
+    Timer t;
     search_variant(variants);
+#ifndef __ANDROID_RECOVERY__
+    // Recovery runs no ART.
     set_dalvik_heap();
+#endif
+    // Picked up from the kernel log by boot/recoverytime.py.
+    LOG(INFO) << "vendor_load_properties took " << t;
 }
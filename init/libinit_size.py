@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Check the init vendor library against its size budget.
+
+  libinit_size.py [--budget BYTES] [--verbose] ARCHIVE
+
+ARCHIVE is the built init_xiaomi_raphael static library, usually the
+recovery variant, which ends up in the recovery ramdisk's init:
+
+  out/soong/.intermediates/device/xiaomi/raphael/init/init_xiaomi_raphael/
+      android_recovery_arm64_armv8-a_static/init_xiaomi_raphael.a
+
+The size is what the members add to init: their allocated ELF sections
+(code, read-only data, data, bss). init links libbase on its own, so a
+member that was not built from a source in this directory means a
+library got bundled in whole, which is an error regardless of the
+budget, as is going over it.
+"""
+
+import argparse
+import glob
+import os
+import struct
+import sys
+
+# Unstripped, so generous; a bundled libbase alone is several times this.
+DEFAULT_BUDGET = 48 * 1024
+
+SHF_ALLOC = 0x2
+
+
+def read_archive(path):
+    """Yields (member name, bytes) of a regular or thin ar archive."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    thin = data.startswith(b'!<thin>\n')
+    if not thin and not data.startswith(b'!<arch>\n'):
+        sys.exit('%s: not an ar archive' % path)
+
+    names = b''
+    offset = 8
+    while offset + 60 <= len(data):
+        header = data[offset:offset + 60]
+        name = header[:16].decode().rstrip()
+        size = int(header[48:58].decode())
+        offset += 60
+        special = name in ('/', '//', '/SYM64/')
+        body = data[offset:offset + size] if not thin or special else None
+        if name == '//':
+            names = body
+        elif name.startswith('#1/'):
+            # BSD: the name precedes the data.
+            length = int(name[3:])
+            name, body = body[:length].rstrip(b'\0').decode(), body[length:]
+        elif name.startswith('/') and not special:
+            start = int(name[1:])
+            name = names[start:names.index(b'\n', start)].decode().rstrip('/')
+        else:
+            name = name.rstrip('/')
+        if not special:
+            if thin:
+                with open(os.path.join(os.path.dirname(path), name), 'rb') as member:
+                    body = member.read()
+            yield os.path.basename(name), body
+        if not thin or special:
+            offset += size + (size & 1)
+
+
+def alloc_size(name, elf):
+    """Sum of the SHF_ALLOC section sizes of a relocatable ELF object."""
+    if elf[:4] != b'\x7fELF':
+        sys.exit('%s: not an ELF object' % name)
+    is64 = elf[4] == 2
+    endian = '<' if elf[5] == 1 else '>'
+    if is64:
+        shoff, = struct.unpack_from(endian + 'Q', elf, 0x28)
+        shentsize, shnum = struct.unpack_from(endian + 'HH', elf, 0x3a)
+    else:
+        shoff, = struct.unpack_from(endian + 'I', elf, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + 'HH', elf, 0x2e)
+
+    total = 0
+    for i in range(shnum):
+        base = shoff + i * shentsize
+        if is64:
+            flags, = struct.unpack_from(endian + 'Q', elf, base + 0x08)
+            size, = struct.unpack_from(endian + 'Q', elf, base + 0x20)
+        else:
+            flags, = struct.unpack_from(endian + 'I', elf, base + 0x08)
+            size, = struct.unpack_from(endian + 'I', elf, base + 0x14)
+        if flags & SHF_ALLOC:
+            total += size
+    return total
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--budget', type=int, default=DEFAULT_BUDGET)
+    parser.add_argument('--verbose', action='store_true')
+    parser.add_argument('archive')
+    args = parser.parse_args()
+
+    own = {os.path.splitext(os.path.basename(src))[0] + '.o'
+           for src in glob.glob(os.path.join(here, '*.cpp'))}
+
+    total = 0
+    foreign = []
+    for name, body in read_archive(args.archive):
+        size = alloc_size(name, body)
+        total += size
+        if name not in own:
+            foreign.append((name, size))
+        if args.verbose:
+            print('%8d  %s' % (size, name))
+
+    print('%d bytes, budget %d' % (total, args.budget))
+    if foreign:
+        print('error: %d members not built from init/ (%d bytes), a library is bundled '
+              'in whole: %s' % (len(foreign), sum(size for _, size in foreign),
+                                ' '.join(sorted(name for name, _ in foreign)[:10])),
+              file=sys.stderr)
+    if total > args.budget:
+        print('error: %d bytes over budget' % (total - args.budget), file=sys.stderr)
+    return 1 if foreign or total > args.budget else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -14,17 +14,22 @@ using android::base::GetProperty;
 #define HWC_PROP "ro.boot.hwc"
 #define SKU_PROP "ro.boot.product.hardware.sku"
 
-void search_variant(const std::vector<variant_info_t> variants) {
-    std::string hwc_value = GetProperty(HWC_PROP, "");
-    std::string sku_value = GetProperty(SKU_PROP, "");
-
+const variant_info_t* find_variant(const std::vector<variant_info_t>& variants,
+                                   const std::string& hwc_value, const std::string& sku_value) {
     for (const auto& variant : variants) {
         if ((variant.hwc_value == "" || variant.hwc_value == hwc_value) &&
             (variant.sku_value == "" || variant.sku_value == sku_value)) {
-            set_variant_props(variant);
-            break;
+            return &variant;
         }
     }
+    return nullptr;
+}
+
+void search_variant(const std::vector<variant_info_t> variants) {
+    const variant_info_t* variant =
+            find_variant(variants, GetProperty(HWC_PROP, ""), GetProperty(SKU_PROP, ""));
+    if (variant != nullptr)
+        set_variant_props(*variant);
 }
 
 void set_variant_props(const variant_info_t variant) {
@@ -38,9 +43,12 @@ void set_variant_props(const variant_info_t variant) {
     set_ro_build_prop("fingerprint", variant.build_fingerprint, false);
     set_ro_build_prop("description", fingerprint_to_description(variant.build_fingerprint), false);
 
+#ifndef __ANDROID_RECOVERY__
+    // Recovery only needs the build props, for the OTA asserts.
     property_override("ro.com.google.clientidbase", "android-xiaomi");
     property_override("ro.com.google.clientidbase.ms", "android-xiaomi-rev1");
 
     if (variant.nfc)
         property_override(SKU_PROP, "nfc");
+#endif
 }
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Measure wake latency from a key press or double tap to display on.
+
+  wake_latency.py [-s SERIAL] [--modes key,tap] [--iterations N] [--settle MS]
+  wake_latency.py [-s SERIAL] --listen [--device /dev/input/event3] [--iterations N]
+  wake_latency.py --probe-output FILE --logcat FILE
+
+wake_latency_probe injects the wake events through uinput (or, with
+--listen, waits for real double taps on the touchscreen) and records
+when each one was injected, delivered by evdev and when the display
+came on. PowerManagerService's "Waking up from" log line marks when
+the event made it through InputReader and the window manager policy.
+The stages reported per mode are:
+
+  inject -> evdev    uinput write to kernel delivery
+  evdev -> wake      InputReader, policy, PowerManager.wakeUp()
+  wake -> display    display power on until the backlight is lit
+  total              first timestamp to display on
+
+Injected double taps start at evdev, so the time the touch controller
+takes to recognize the gesture is only covered by --listen.
+
+The second form analyzes a saved probe output and logcat -v monotonic.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+DEVICE_PROBE = '/vendor/bin/wake_latency_probe'
+
+# logcat -v monotonic: seconds since boot on CLOCK_MONOTONIC, the clock
+# the probe stamps with.
+WAKE_RE = re.compile(r'^\s*(\d+\.\d+)\s.*PowerManagerService: Waking up from \w+ '
+                     r'\(uid=\d+, reason=(\w+)')
+
+STAGES = [
+    ('inject -> evdev', 'inject', 'evdev'),
+    ('evdev -> wake', 'evdev', 'wake'),
+    ('wake -> display', 'wake', 'display'),
+]
+
+
+def parse_probe(text):
+    runs = []
+    for line in text.splitlines():
+        fields = dict(field.split('=', 1) for field in line.split() if '=' in field)
+        if 'iter' not in fields:
+            continue
+        run = {'mode': fields['mode']}
+        for stage in ('inject', 'evdev', 'display'):
+            value = float(fields[stage + '_ms'])
+            run[stage] = value if value >= 0 else None
+        runs.append(run)
+    return runs
+
+
+def parse_wakes(text):
+    wakes = []
+    for line in text.splitlines():
+        match = WAKE_RE.match(line)
+        if match:
+            wakes.append((float(match.group(1)) * 1000, match.group(2)))
+    return sorted(wakes)
+
+
+def attach_wakes(runs, wakes):
+    """Pairs every run with the first wake between its start and display on."""
+    for run in runs:
+        start = run['inject'] if run['inject'] is not None else run['evdev']
+        run['wake'] = None
+        run['reason'] = None
+        if start is None:
+            continue
+        for ms, reason in wakes:
+            # logcat has ms resolution, the probe us.
+            if ms >= start - 1 and (run['display'] is None or ms <= run['display']):
+                run['wake'] = max(ms, run['evdev'] or ms)
+                run['reason'] = reason
+                break
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(round(p / 100 * (len(values) - 1))))]
+
+
+def describe(values):
+    if not values:
+        return '%-8s' % 'n/a'
+    return 'n %-3d min %7.1f  p50 %7.1f  p90 %7.1f  max %7.1f' % (
+        len(values), min(values), percentile(values, 50), percentile(values, 90), max(values))
+
+
+def report(runs):
+    medians = {}
+    for mode in sorted(set(run['mode'] for run in runs)):
+        selected = [run for run in runs if run['mode'] == mode]
+        reasons = sorted(set(run['reason'] for run in selected if run['reason']))
+        print('%s (%s)' % (mode, ', '.join(reasons) or 'no wake logged'))
+        for name, first, last in STAGES:
+            values = [run[last] - run[first] for run in selected
+                      if run[first] is not None and run[last] is not None]
+            print('  %-16s %s' % (name, describe(values)))
+        totals = []
+        for run in selected:
+            start = run['inject'] if run['inject'] is not None else run['evdev']
+            if start is not None and run['display'] is not None:
+                totals.append(run['display'] - start)
+        print('  %-16s %s' % ('total', describe(totals)))
+        missed = sum(1 for run in selected if run['display'] is None)
+        if missed:
+            print('  %d of %d iterations did not turn the display on' % (missed, len(selected)))
+        if totals:
+            medians[mode] = percentile(totals, 50)
+    if 'key' in medians and len(medians) > 1:
+        for mode, median in medians.items():
+            if mode != 'key':
+                print('%s is %+.1f ms vs key at the median' % (mode, median - medians['key']))
+
+
+def adb(serial, *args):
+    command = ['adb'] + (['-s', serial] if serial else []) + list(args)
+    return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('-s', '--serial')
+    parser.add_argument('--modes', default='key,tap')
+    parser.add_argument('--listen', action='store_true')
+    parser.add_argument('--device', default='/dev/input/event3')
+    parser.add_argument('--iterations', type=int, default=20)
+    parser.add_argument('--settle', type=int, default=3000)
+    parser.add_argument('--probe-output')
+    parser.add_argument('--logcat')
+    args = parser.parse_args()
+
+    if args.probe_output or args.logcat:
+        if not (args.probe_output and args.logcat):
+            parser.error('--probe-output and --logcat go together')
+        with open(args.probe_output, 'r') as f:
+            runs = parse_probe(f.read())
+        with open(args.logcat, 'r', errors='replace') as f:
+            attach_wakes(runs, parse_wakes(f.read()))
+        report(runs)
+        return 0
+
+    adb(args.serial, 'root')
+    adb(args.serial, 'wait-for-device')
+    runs = []
+    modes = ['listen'] if args.listen else args.modes.split(',')
+    for mode in modes:
+        adb(args.serial, 'logcat', '-c')
+        command = [DEVICE_PROBE, '-m', mode, '-n', str(args.iterations), '-s', str(args.settle)]
+        if mode == 'listen':
+            command += ['-d', args.device]
+            print('double tap the screen each time it is off', file=sys.stderr)
+        mode_runs = parse_probe(adb(args.serial, 'shell', ' '.join(command)))
+        attach_wakes(mode_runs, parse_wakes(
+            adb(args.serial, 'logcat', '-d', '-v', 'monotonic', '-b', 'system,main')))
+        runs += mode_runs
+    report(runs)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Wakes the device with an injected key or double-tap gesture and
+// timestamps how far the event got: when it was written to uinput, the
+// kernel timestamp it was delivered to evdev readers with, and when the
+// display came on. In listen mode nothing is injected and real gestures
+// on an input device (the touchscreen, /dev/input/event3) are timed
+// from their evdev timestamp instead.
+//
+// The display is observed through a stub that polls the panel
+// backlight; it turns non-zero once the display is on and unblocked.
+// Between iterations the device is put back to sleep with KEY_SLEEP.
+//
+// Injected events go through the key layout of the device name they are
+// created with, so -N gpio-keys exercises keylayout/gpio-keys.kl.
+//
+// Output is one key=value line per iteration for wake_latency.py, all
+// times in CLOCK_MONOTONIC ms, -1 for a stage that was not reached.
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+namespace {
+
+struct Options {
+    std::string mode = "key";
+    std::string name;
+    std::string listenDevice = "/dev/input/event3";
+    std::string backlight = "/sys/class/backlight/panel0-backlight/brightness";
+    int code = -1;
+    unsigned int iterations = 20;
+    unsigned int settleMs = 3000;
+    unsigned int timeoutMs = 5000;
+};
+
+// What the real sources report: the PMIC power key and the touch
+// controller's wake gesture.
+constexpr char kKeyName[] = "qpnp_pon";
+constexpr char kTapName[] = "uinput-dt2w";
+constexpr int kTapCode = KEY_WAKEUP;
+// InputReader needs a moment to open a new device and load its layout.
+constexpr unsigned int kDeviceSettleMs = 1000;
+
+double NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+double EventMs(const input_event& ev) {
+    return ev.input_event_sec * 1e3 + ev.input_event_usec / 1e3;
+}
+
+void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [-m key|tap|listen] [-k code] [-N device name] [-d listen device]\n"
+            "          [-b backlight node] [-n iterations] [-s settle ms] [-t timeout ms]\n",
+            name);
+}
+
+// Display on stub: the backlight level, 0 while the panel is off.
+bool DisplayOn(const std::string& backlight) {
+    FILE* f = fopen(backlight.c_str(), "r");
+    if (!f) return false;
+    int level = 0;
+    bool ok = fscanf(f, "%d", &level) == 1;
+    fclose(f);
+    return ok && level > 0;
+}
+
+// Polls the stub every ms until it reads on (or off); returns when, or -1.
+double WaitDisplay(const Options& o, bool on) {
+    double deadline = NowMs() + o.timeoutMs;
+    while (NowMs() < deadline) {
+        if (DisplayOn(o.backlight) == on) return NowMs();
+        usleep(1000);
+    }
+    return -1;
+}
+
+bool Emit(int fd, int code, int value) {
+    input_event ev[2] = {};
+    ev[0].type = EV_KEY;
+    ev[0].code = code;
+    ev[0].value = value;
+    ev[1].type = EV_SYN;
+    ev[1].code = SYN_REPORT;
+    return write(fd, ev, sizeof(ev)) == sizeof(ev);
+}
+
+int CreateUinput(const std::string& name, int code) {
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        perror("/dev/uinput");
+        return -1;
+    }
+    uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    strncpy(setup.name, name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+    if (ioctl(fd, UI_SET_EVBIT, EV_KEY) || ioctl(fd, UI_SET_EVBIT, EV_SYN) ||
+        ioctl(fd, UI_SET_KEYBIT, KEY_SLEEP) || (code >= 0 && ioctl(fd, UI_SET_KEYBIT, code)) ||
+        ioctl(fd, UI_DEV_SETUP, &setup) || ioctl(fd, UI_DEV_CREATE)) {
+        perror("uinput setup");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// The evdev node of our own uinput device, to see when the kernel
+// delivered the event.
+int OpenEvdev(int uinput) {
+    char sysname[64] = {};
+    if (ioctl(uinput, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) return -1;
+    std::string dir = std::string("/sys/devices/virtual/input/") + sysname;
+    for (int i = 0; i < 256; i++) {
+        std::string node = dir + "/event" + std::to_string(i);
+        if (access(node.c_str(), F_OK) == 0) {
+            return open(("/dev/input/event" + std::to_string(i)).c_str(),
+                        O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        }
+    }
+    return -1;
+}
+
+// Waits for a key down of code on a non-blocking evdev fd, returns its
+// timestamp.
+double WaitKey(int fd, int code, unsigned int timeoutMs) {
+    double deadline = NowMs() + timeoutMs;
+    while (true) {
+        int left = static_cast<int>(deadline - NowMs());
+        if (left <= 0) return -1;
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, left) <= 0) continue;
+        input_event ev;
+        while (read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+            if (ev.type == EV_KEY && ev.code == code && ev.value == 1) return EventMs(ev);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:k:N:d:b:n:s:t:h")) != -1) {
+        switch (opt) {
+            case 'm': o.mode = optarg; break;
+            case 'k': o.code = atoi(optarg); break;
+            case 'N': o.name = optarg; break;
+            case 'd': o.listenDevice = optarg; break;
+            case 'b': o.backlight = optarg; break;
+            case 'n': o.iterations = atoi(optarg); break;
+            case 's': o.settleMs = atoi(optarg); break;
+            case 't': o.timeoutMs = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    bool listen = o.mode == "listen";
+    if ((o.mode != "key" && o.mode != "tap" && !listen) || !o.iterations) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (o.code < 0) o.code = o.mode == "key" ? KEY_POWER : kTapCode;
+    if (o.name.empty()) o.name = o.mode == "key" ? kKeyName : kTapName;
+
+    // Listening still injects KEY_SLEEP to end each iteration.
+    int uinput = CreateUinput(o.name, listen ? -1 : o.code);
+    if (uinput < 0) return 1;
+    int evdev = listen ? open(o.listenDevice.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)
+                       : OpenEvdev(uinput);
+    if (evdev < 0) {
+        perror(listen ? o.listenDevice.c_str() : "uinput evdev node");
+        ioctl(uinput, UI_DEV_DESTROY);
+        close(uinput);
+        return 1;
+    }
+    int clock = CLOCK_MONOTONIC;
+    ioctl(evdev, EVIOCSCLOCKID, &clock);
+    usleep(kDeviceSettleMs * 1000);
+
+    for (unsigned int i = 0; i < o.iterations; i++) {
+        if (DisplayOn(o.backlight)) {
+            Emit(uinput, KEY_SLEEP, 1);
+            Emit(uinput, KEY_SLEEP, 0);
+            if (WaitDisplay(o, false) < 0) {
+                fprintf(stderr, "display did not turn off\n");
+                break;
+            }
+        }
+        usleep(o.settleMs * 1000);
+
+        // Drop anything queued while the device went to sleep.
+        input_event stale;
+        while (read(evdev, &stale, sizeof(stale)) == sizeof(stale)) {
+        }
+
+        double inject = -1;
+        if (listen) {
+            fprintf(stderr, "iteration %u: double tap the screen\n", i);
+        } else {
+            inject = NowMs();
+            Emit(uinput, o.code, 1);
+            Emit(uinput, o.code, 0);
+        }
+        double delivered = WaitKey(evdev, o.code, listen ? 60000 : o.timeoutMs);
+        double display = delivered >= 0 ? WaitDisplay(o, true) : -1;
+        printf("iter=%u mode=%s code=%d inject_ms=%.3f evdev_ms=%.3f display_ms=%.3f\n", i,
+               o.mode.c_str(), o.code, inject, delivered, display);
+        fflush(stdout);
+    }
+
+    ioctl(uinput, UI_DEV_DESTROY);
+    close(uinput);
+    close(evdev);
+    return 0;
+}
@@ -1,13 +1,76 @@
 #define LOG_TAG "libqti-perfd-client"
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <log/log.h>
 
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <PmQosClient.h>
+
+using vendor::pmqos::PmQosClient;
+
+namespace {
+
+// Perf lock resource that keeps every CPU out of power collapse, the one
+// the camera and audio blobs take around latency critical work.
+constexpr int kAllCpusPowerCollapseDisable = 0x40400000;
+// The same as the power HAL requests on launch, see PMQoSCpuDmaLatency.
+constexpr int32_t kPowerCollapseDisableUs = 44;
+// Handles of locks turned into votes, apart from the ones echoed back.
+constexpr int kFirstVoteHandle = 1000;
+
+std::mutex gLock;
+PmQosClient gClient;
+bool gConnected = false;
+int gNextHandle = kFirstVoteHandle;
+// handle -> vendor.pmqos vote id
+std::map<int, int> gVotes;
+
+int Vote(int duration) {
+    std::string name = std::string("perfd:") + getprogname();
+    int id = gConnected ? gClient.vote(name, kPowerCollapseDisableUs, duration) : -1;
+    if (id < 0) {
+        // vendor.pmqos may have restarted and dropped our connection,
+        // along with its votes. The new daemon numbers votes from 1 again,
+        // so the ids we hold would release someone else's votes.
+        gConnected = gClient.connect();
+        gVotes.clear();
+        if (gConnected) id = gClient.vote(name, kPowerCollapseDisableUs, duration);
+    }
+    return id;
+}
+
+}  // namespace
+
 extern "C" void perf_get_feedback() {}
 extern "C" void perf_hint() {}
 extern "C" int perf_lock_acq(int handle, int duration, int arg3[], int arg4) {
     ALOGI("perf_lock_acq: handle: %d, duration: %d, arg3[0]: %d, arg4: %d",
             handle, duration, arg3[0], arg4);
+    for (int i = 0; i + 1 < arg4; i += 2) {
+        if (arg3[i] != kAllCpusPowerCollapseDisable || arg3[i + 1] == 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock(gLock);
+        auto it = gVotes.find(handle);
+        if (it != gVotes.end()) {
+            // Reacquiring replaces the vote, with the new duration.
+            gClient.release(it->second);
+            gVotes.erase(it);
+        } else {
+            handle = gNextHandle++;
+        }
+        int id = Vote(duration);
+        if (id < 0) {
+            ALOGW("perf_lock_acq: vendor.pmqos unavailable, no latency vote");
+            break;
+        }
+        gVotes[handle] = id;
+        return handle;
+    }
     if (handle > 0)
         return handle;
 
@@ -16,6 +79,14 @@ extern "C" int perf_lock_acq(int handle, int duration, int arg3[], int arg4) {
 extern "C" void perf_lock_cmd() {}
 extern "C" int perf_lock_rel(int handle) {
     ALOGI("perf_lock_rel: handle: %d", handle);
+    {
+        std::lock_guard<std::mutex> lock(gLock);
+        auto it = gVotes.find(handle);
+        if (it != gVotes.end()) {
+            gClient.release(it->second);
+            gVotes.erase(it);
+        }
+    }
     if (handle > 0)
         return handle;
 
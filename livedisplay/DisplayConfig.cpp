@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "DisplayConfig"
+
+#include "DisplayConfig.h"
+
+#include <android-base/logging.h>
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+DisplayConfig::DisplayConfig(SdmDisplay& display) : mDisplay(display) {}
+
+bool DisplayConfig::loadModesLocked() {
+    if (mModes) return true;
+    std::vector<ModeInfo> modes;
+    mQueries++;
+    if (!mDisplay.getModes(&modes)) return false;
+    mModes = std::move(modes);
+    return true;
+}
+
+bool DisplayConfig::loadActiveLocked() {
+    if (mActive) return true;
+    int32_t id;
+    mQueries++;
+    if (!mDisplay.getActiveMode(&id)) return false;
+    mActive = id;
+    return true;
+}
+
+bool DisplayConfig::loadDefaultLocked() {
+    if (mDefault) return true;
+    int32_t id;
+    mQueries++;
+    if (!mDisplay.getDefaultMode(&id)) return false;
+    mDefault = id;
+    return true;
+}
+
+bool DisplayConfig::loadPaRangesLocked() {
+    if (mPaRanges) return true;
+    if (!mHasPa) {
+        mQueries++;
+        mHasPa = mDisplay.hasPa();
+    }
+    if (!*mHasPa) return false;
+    PaRanges ranges;
+    mQueries++;
+    if (!mDisplay.getPaRanges(&ranges)) return false;
+    mPaRanges = ranges;
+    return true;
+}
+
+bool DisplayConfig::loadPaLocked() {
+    if (mPa) return true;
+    if (!loadPaRangesLocked()) return false;
+    PaValues pa;
+    mQueries++;
+    if (!mDisplay.getPa(&pa)) return false;
+    mPa = pa;
+    if (!mDefaultPa) mDefaultPa = pa;
+    return true;
+}
+
+bool DisplayConfig::findModeLocked(int32_t id, ModeInfo* mode) {
+    if (!loadModesLocked()) return false;
+    for (const auto& m : *mModes) {
+        if (m.id == id) {
+            *mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DisplayConfig::validPaLocked(const PaValues& pa) {
+    if (!loadPaRangesLocked()) return false;
+    const PaRanges& r = *mPaRanges;
+    return r.hue.contains(pa.hue) && r.saturation.contains(pa.saturation) &&
+           r.intensity.contains(pa.intensity) && r.contrast.contains(pa.contrast) &&
+           r.saturationThreshold.contains(pa.saturationThreshold);
+}
+
+void DisplayConfig::restoreModeLocked(std::optional<int32_t> previous) {
+    if (!previous) return;
+    mSets++;
+    // Switching back loads the PA of that mode again.
+    mPa.reset();
+    mDefaultPa.reset();
+    if (mDisplay.setActiveMode(*previous)) {
+        mActive = previous;
+    } else {
+        LOG(ERROR) << "Failed to restore display mode " << *previous;
+        mActive.reset();
+    }
+}
+
+bool DisplayConfig::modes(std::vector<ModeInfo>* modes) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!loadModesLocked()) return false;
+    *modes = *mModes;
+    return true;
+}
+
+bool DisplayConfig::activeMode(ModeInfo* mode) {
+    std::lock_guard<std::mutex> lock(mLock);
+    return loadActiveLocked() && findModeLocked(*mActive, mode);
+}
+
+bool DisplayConfig::defaultMode(ModeInfo* mode) {
+    std::lock_guard<std::mutex> lock(mLock);
+    return loadDefaultLocked() && findModeLocked(*mDefault, mode);
+}
+
+bool DisplayConfig::hasPa() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return loadPaRangesLocked();
+}
+
+bool DisplayConfig::paRanges(PaRanges* ranges) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!loadPaRangesLocked()) return false;
+    *ranges = *mPaRanges;
+    return true;
+}
+
+bool DisplayConfig::pa(PaValues* pa) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!loadPaLocked()) return false;
+    *pa = *mPa;
+    return true;
+}
+
+bool DisplayConfig::defaultPa(PaValues* pa) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!loadPaLocked()) return false;
+    *pa = *mDefaultPa;
+    return true;
+}
+
+bool DisplayConfig::apply(const Change& change) {
+    std::lock_guard<std::mutex> lock(mLock);
+
+    ModeInfo mode;
+    if (change.mode) {
+        if (!findModeLocked(*change.mode, &mode)) {
+            LOG(ERROR) << "Unknown display mode " << *change.mode;
+            return false;
+        }
+        if (!loadActiveLocked() || (change.makeDefault && !loadDefaultLocked())) return false;
+    }
+    if (change.pa && !validPaLocked(*change.pa)) {
+        LOG(ERROR) << "Picture adjustment out of range";
+        return false;
+    }
+
+    std::optional<int32_t> previous;
+    if (change.mode && *change.mode != *mActive) {
+        mSets++;
+        if (!mDisplay.setActiveMode(*change.mode)) {
+            LOG(ERROR) << "Failed to set display mode " << mode.name;
+            // The daemon may or may not have switched.
+            mActive.reset();
+            mPa.reset();
+            mDefaultPa.reset();
+            return false;
+        }
+        previous = mActive;
+        mActive = *change.mode;
+        // A mode carries its own PA, which is also what a reset goes back
+        // to now. Read it again before comparing.
+        mPa.reset();
+        mDefaultPa.reset();
+    }
+
+    if (change.pa) {
+        if (!loadPaLocked()) {
+            restoreModeLocked(previous);
+            return false;
+        }
+        if (*change.pa != *mPa) {
+            mSets++;
+            if (!mDisplay.setPa(*change.pa)) {
+                LOG(ERROR) << "Failed to set picture adjustment";
+                mPa.reset();
+                restoreModeLocked(previous);
+                return false;
+            }
+            mPa = *change.pa;
+        }
+    }
+
+    if (change.mode && change.makeDefault && *change.mode != *mDefault) {
+        mSets++;
+        if (!mDisplay.setDefaultMode(*change.mode)) {
+            LOG(ERROR) << "Failed to make display mode " << mode.name << " the default";
+            mDefault.reset();
+            return false;
+        }
+        mDefault = *change.mode;
+    }
+    return true;
+}
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VENDOR_LINEAGE_LIVEDISPLAY_V2_1_DISPLAYCONFIG_H
+#define VENDOR_LINEAGE_LIVEDISPLAY_V2_1_DISPLAYCONFIG_H
+
+#include <mutex>
+#include <optional>
+
+#include "SdmDisplay.h"
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+// What the display modes and picture adjustment services share: the
+// mode list, active and default mode and the PA state, each read from
+// the display daemon once and kept up to date by the changes made
+// through here, which is the only writer.
+class DisplayConfig {
+  public:
+    struct Change {
+        std::optional<int32_t> mode;
+        bool makeDefault = false;
+        std::optional<PaValues> pa;
+    };
+
+    explicit DisplayConfig(SdmDisplay& display);
+
+    bool modes(std::vector<ModeInfo>* modes);
+    bool activeMode(ModeInfo* mode);
+    bool defaultMode(ModeInfo* mode);
+
+    bool hasPa();
+    bool paRanges(PaRanges* ranges);
+    bool pa(PaValues* pa);
+    // The PA the active mode came with, before anything was set
+    // through here.
+    bool defaultPa(PaValues* pa);
+
+    // Applies everything in the change or nothing: the change is
+    // validated up front, parts that match the current state are
+    // skipped and a failed PA read or update reverts the mode switch
+    // before it.
+    // The default mode is only written once the rest succeeded.
+    bool apply(const Change& change);
+
+    // SDM calls made so far; every set but the default mode one is a
+    // display refresh.
+    uint64_t queries() const { return mQueries; }
+    uint64_t sets() const { return mSets; }
+
+  private:
+    bool loadModesLocked();
+    bool loadActiveLocked();
+    bool loadDefaultLocked();
+    bool loadPaRangesLocked();
+    bool loadPaLocked();
+    bool findModeLocked(int32_t id, ModeInfo* mode);
+    bool validPaLocked(const PaValues& pa);
+    // Switches back to the mode active before a failed change, if any.
+    void restoreModeLocked(std::optional<int32_t> previous);
+
+    SdmDisplay& mDisplay;
+    std::mutex mLock;
+
+    std::optional<std::vector<ModeInfo>> mModes;
+    std::optional<int32_t> mActive;
+    std::optional<int32_t> mDefault;
+    std::optional<bool> mHasPa;
+    std::optional<PaRanges> mPaRanges;
+    std::optional<PaValues> mPa;
+    std::optional<PaValues> mDefaultPa;
+
+    uint64_t mQueries = 0;
+    uint64_t mSets = 0;
+};
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
+
+#endif  // VENDOR_LINEAGE_LIVEDISPLAY_V2_1_DISPLAYCONFIG_H
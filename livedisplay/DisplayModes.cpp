@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "DisplayModesService"
+
+#include "DisplayModes.h"
+
+#include <android-base/logging.h>
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+using ::vendor::lineage::livedisplay::V2_0::DisplayMode;
+
+namespace {
+
+DisplayMode toHidl(const ModeInfo& mode) {
+    return {mode.id, mode.name};
+}
+
+// What the interface returns when there is no mode to report.
+const DisplayMode kInvalidMode = {-1, ""};
+
+}  // anonymous namespace
+
+DisplayModes::DisplayModes(std::shared_ptr<DisplayConfig> config) : mConfig(std::move(config)) {}
+
+bool DisplayModes::isSupported() {
+    std::vector<ModeInfo> modes;
+    return mConfig->modes(&modes) && !modes.empty();
+}
+
+Return<void> DisplayModes::getDisplayModes(getDisplayModes_cb _hidl_cb) {
+    std::vector<ModeInfo> modes;
+    std::vector<DisplayMode> result;
+    if (mConfig->modes(&modes)) {
+        for (const auto& mode : modes) result.push_back(toHidl(mode));
+    }
+    _hidl_cb(result);
+    return Void();
+}
+
+Return<void> DisplayModes::getCurrentDisplayMode(getCurrentDisplayMode_cb _hidl_cb) {
+    ModeInfo mode;
+    _hidl_cb(mConfig->activeMode(&mode) ? toHidl(mode) : kInvalidMode);
+    return Void();
+}
+
+Return<void> DisplayModes::getDefaultDisplayMode(getDefaultDisplayMode_cb _hidl_cb) {
+    ModeInfo mode;
+    _hidl_cb(mConfig->defaultMode(&mode) ? toHidl(mode) : kInvalidMode);
+    return Void();
+}
+
+Return<bool> DisplayModes::setDisplayMode(int32_t modeID, bool makeDefault) {
+    DisplayConfig::Change change;
+    change.mode = modeID;
+    change.makeDefault = makeDefault;
+    return mConfig->apply(change);
+}
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
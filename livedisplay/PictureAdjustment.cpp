@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "PictureAdjustmentService"
+
+#include "PictureAdjustment.h"
+
+#include <android-base/logging.h>
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+namespace {
+
+HSIC toHidl(const PaValues& pa) {
+    return {pa.hue, pa.saturation, pa.intensity, pa.contrast, pa.saturationThreshold};
+}
+
+}  // anonymous namespace
+
+PictureAdjustment::PictureAdjustment(std::shared_ptr<DisplayConfig> config)
+    : mConfig(std::move(config)) {
+    // Read the PA before anyone can change it, it is what
+    // getDefaultPictureAdjustment returns.
+    PaValues pa;
+    mConfig->defaultPa(&pa);
+}
+
+bool PictureAdjustment::isSupported() {
+    return mConfig->hasPa();
+}
+
+FloatRange PictureAdjustment::floatRange(PaRange PaRanges::*field) {
+    PaRanges ranges;
+    if (!mConfig->paRanges(&ranges)) return {0, 0, 0};
+    const PaRange& r = ranges.*field;
+    return {r.min, r.max, r.step};
+}
+
+Return<void> PictureAdjustment::getHueRange(getHueRange_cb _hidl_cb) {
+    PaRanges ranges;
+    Range range = {0, 0};
+    if (mConfig->paRanges(&ranges)) {
+        range = {int32_t(ranges.hue.min), int32_t(ranges.hue.max)};
+    }
+    _hidl_cb(range);
+    return Void();
+}
+
+Return<void> PictureAdjustment::getSaturationRange(getSaturationRange_cb _hidl_cb) {
+    _hidl_cb(floatRange(&PaRanges::saturation));
+    return Void();
+}
+
+Return<void> PictureAdjustment::getIntensityRange(getIntensityRange_cb _hidl_cb) {
+    _hidl_cb(floatRange(&PaRanges::intensity));
+    return Void();
+}
+
+Return<void> PictureAdjustment::getContrastRange(getContrastRange_cb _hidl_cb) {
+    _hidl_cb(floatRange(&PaRanges::contrast));
+    return Void();
+}
+
+Return<void> PictureAdjustment::getSaturationThresholdRange(
+        getSaturationThresholdRange_cb _hidl_cb) {
+    _hidl_cb(floatRange(&PaRanges::saturationThreshold));
+    return Void();
+}
+
+Return<void> PictureAdjustment::getPictureAdjustment(getPictureAdjustment_cb _hidl_cb) {
+    PaValues pa{};
+    mConfig->pa(&pa);
+    _hidl_cb(toHidl(pa));
+    return Void();
+}
+
+Return<void> PictureAdjustment::getDefaultPictureAdjustment(
+        getDefaultPictureAdjustment_cb _hidl_cb) {
+    PaValues pa{};
+    mConfig->defaultPa(&pa);
+    _hidl_cb(toHidl(pa));
+    return Void();
+}
+
+Return<bool> PictureAdjustment::setPictureAdjustment(const HSIC& hsic) {
+    DisplayConfig::Change change;
+    change.pa = PaValues{hsic.hue, hsic.saturation, hsic.intensity, hsic.contrast,
+                         hsic.saturationThreshold};
+    return mConfig->apply(change);
+}
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
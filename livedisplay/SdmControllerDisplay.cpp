@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "SdmControllerDisplay"
+
+#include "SdmControllerDisplay.h"
+
+#include <android-base/logging.h>
+#include <cstring>
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+using V2_0::sdm::HsicConfig;
+using V2_0::sdm::HsicRanges;
+using V2_0::sdm::sdm_feature_version;
+using V2_0::sdm::SdmDispMode;
+
+namespace {
+
+constexpr uint32_t kFeatureVerSwPaApi = 1;
+constexpr uint32_t kMinPaApiVersion = 1;
+constexpr int32_t kModeNameLen = 128;
+
+}  // anonymous namespace
+
+SdmControllerDisplay::SdmControllerDisplay(
+        std::shared_ptr<V2_0::sdm::SDMController> controller)
+    : mController(std::move(controller)) {}
+
+bool SdmControllerDisplay::getModes(std::vector<ModeInfo>* modes) {
+    int32_t count = 0;
+    if (mController->getNumDisplayModes(&count) != 0) return false;
+
+    std::vector<SdmDispMode> sdmModes(count);
+    std::vector<std::vector<char>> names(count, std::vector<char>(kModeNameLen));
+    for (int32_t i = 0; i < count; i++) {
+        sdmModes[i].len = kModeNameLen;
+        sdmModes[i].name = names[i].data();
+    }
+    if (count > 0 && mController->getDisplayModes(sdmModes.data(), count) != 0) return false;
+
+    modes->clear();
+    for (const auto& mode : sdmModes) {
+        modes->push_back({mode.id, std::string(mode.name, strnlen(mode.name, kModeNameLen))});
+    }
+    return true;
+}
+
+bool SdmControllerDisplay::getActiveMode(int32_t* id) {
+    return mController->getActiveDisplayMode(id) == 0;
+}
+
+bool SdmControllerDisplay::getDefaultMode(int32_t* id) {
+    return mController->getDefaultDisplayMode(id) == 0;
+}
+
+bool SdmControllerDisplay::setActiveMode(int32_t id) {
+    return mController->setActiveDisplayMode(id) == 0;
+}
+
+bool SdmControllerDisplay::setDefaultMode(int32_t id) {
+    return mController->setDefaultDisplayMode(id) == 0;
+}
+
+bool SdmControllerDisplay::hasPa() {
+    sdm_feature_version version{};
+    if (mController->getFeatureVersion(kFeatureVerSwPaApi, &version) != 0) return false;
+    return version.x >= kMinPaApiVersion;
+}
+
+bool SdmControllerDisplay::getPaRanges(PaRanges* ranges) {
+    HsicRanges r{};
+    if (mController->getGlobalPaRange(&r) != 0) return false;
+    ranges->hue = {float(r.hue.min), float(r.hue.max), float(r.hue.step)};
+    ranges->saturation = {r.saturation.min, r.saturation.max, r.saturation.step};
+    ranges->intensity = {r.intensity.min, r.intensity.max, r.intensity.step};
+    ranges->contrast = {r.contrast.min, r.contrast.max, r.contrast.step};
+    ranges->saturationThreshold = {r.saturationThreshold.min, r.saturationThreshold.max,
+                                   r.saturationThreshold.step};
+    return true;
+}
+
+bool SdmControllerDisplay::getPa(PaValues* pa) {
+    HsicConfig config{};
+    if (mController->getGlobalPaConfig(&config) != 0) return false;
+    *pa = {float(config.data.hue), config.data.saturation, config.data.intensity,
+           config.data.contrast, config.data.saturationThreshold};
+    return true;
+}
+
+bool SdmControllerDisplay::setPa(const PaValues& pa) {
+    HsicConfig config{};
+    config.data.hue = int32_t(pa.hue);
+    config.data.saturation = pa.saturation;
+    config.data.intensity = pa.intensity;
+    config.data.contrast = pa.contrast;
+    config.data.saturationThreshold = pa.saturationThreshold;
+    return mController->setGlobalPaConfig(&config) == 0;
+}
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
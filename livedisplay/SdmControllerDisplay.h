@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMCONTROLLERDISPLAY_H
+#define VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMCONTROLLERDISPLAY_H
+
+#include <memory>
+
+#include "SdmDisplay.h"
+#include "livedisplay/sdm/SDMController.h"
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+class SdmControllerDisplay : public SdmDisplay {
+  public:
+    explicit SdmControllerDisplay(std::shared_ptr<V2_0::sdm::SDMController> controller);
+
+    bool getModes(std::vector<ModeInfo>* modes) override;
+    bool getActiveMode(int32_t* id) override;
+    bool getDefaultMode(int32_t* id) override;
+    bool setActiveMode(int32_t id) override;
+    bool setDefaultMode(int32_t id) override;
+
+    bool hasPa() override;
+    bool getPaRanges(PaRanges* ranges) override;
+    bool getPa(PaValues* pa) override;
+    bool setPa(const PaValues& pa) override;
+
+  private:
+    std::shared_ptr<V2_0::sdm::SDMController> mController;
+};
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
+
+#endif  // VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMCONTROLLERDISPLAY_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMDISPLAY_H
+#define VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMDISPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vendor {
+namespace lineage {
+namespace livedisplay {
+namespace V2_1 {
+namespace implementation {
+
+struct ModeInfo {
+    int32_t id;
+    std::string name;
+};
+
+struct PaValues {
+    float hue;
+    float saturation;
+    float intensity;
+    float contrast;
+    float saturationThreshold;
+
+    bool operator==(const PaValues& o) const {
+        return hue == o.hue && saturation == o.saturation && intensity == o.intensity &&
+               contrast == o.contrast && saturationThreshold == o.saturationThreshold;
+    }
+    bool operator!=(const PaValues& o) const { return !(*this == o); }
+};
+
+struct PaRange {
+    float min;
+    float max;
+    float step;
+
+    bool contains(float v) const { return v >= min && v <= max; }
+};
+
+struct PaRanges {
+    PaRange hue;
+    PaRange saturation;
+    PaRange intensity;
+    PaRange contrast;
+    PaRange saturationThreshold;
+};
+
+// The calls the display color service takes. Every query is a binder
+// round trip to the display daemon and every set a display refresh;
+// SdmControllerDisplay forwards to SDMController, the replay tool fakes
+// it.
+class SdmDisplay {
+  public:
+    virtual ~SdmDisplay() = default;
+
+    virtual bool getModes(std::vector<ModeInfo>* modes) = 0;
+    virtual bool getActiveMode(int32_t* id) = 0;
+    virtual bool getDefaultMode(int32_t* id) = 0;
+    virtual bool setActiveMode(int32_t id) = 0;
+    virtual bool setDefaultMode(int32_t id) = 0;
+
+    virtual bool hasPa() = 0;
+    virtual bool getPaRanges(PaRanges* ranges) = 0;
+    virtual bool getPa(PaValues* pa) = 0;
+    virtual bool setPa(const PaValues& pa) = 0;
+};
+
+}  // namespace implementation
+}  // namespace V2_1
+}  // namespace livedisplay
+}  // namespace lineage
+}  // namespace vendor
+
+#endif  // VENDOR_LINEAGE_LIVEDISPLAY_V2_1_SDMDISPLAY_H
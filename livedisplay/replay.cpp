@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "livedisplay_replay"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+
+#include "DisplayConfig.h"
+
+using android::base::ParseInt;
+using android::base::Split;
+using vendor::lineage::livedisplay::V2_1::implementation::DisplayConfig;
+using vendor::lineage::livedisplay::V2_1::implementation::ModeInfo;
+using vendor::lineage::livedisplay::V2_1::implementation::PaRanges;
+using vendor::lineage::livedisplay::V2_1::implementation::PaValues;
+using vendor::lineage::livedisplay::V2_1::implementation::SdmDisplay;
+
+namespace {
+
+std::ostream& operator<<(std::ostream& os, const PaValues& pa) {
+    return os << pa.hue << "," << pa.saturation << "," << pa.intensity << "," << pa.contrast
+              << "," << pa.saturationThreshold;
+}
+
+// Stands in for the display daemon: prints every call, fails the ones
+// named by "fail", and switching modes loads the PA of the mode.
+class FakeSdmDisplay : public SdmDisplay {
+  public:
+    std::vector<ModeInfo> modes;
+    std::vector<PaValues> modePa;
+    int32_t active = 0;
+    int32_t defaultId = 0;
+    PaValues pa{0, 0, 0, 0, 0};
+    std::set<std::string> failing;
+
+    bool getModes(std::vector<ModeInfo>* out) override {
+        *out = modes;
+        return call("get_modes");
+    }
+    bool getActiveMode(int32_t* id) override {
+        *id = active;
+        return call("get_active_mode");
+    }
+    bool getDefaultMode(int32_t* id) override {
+        *id = defaultId;
+        return call("get_default_mode");
+    }
+    bool setActiveMode(int32_t id) override {
+        if (!call("set_active_mode", std::to_string(id))) return false;
+        active = id;
+        for (size_t i = 0; i < modes.size(); i++) {
+            if (modes[i].id == id) pa = modePa[i];
+        }
+        return true;
+    }
+    bool setDefaultMode(int32_t id) override {
+        if (!call("set_default_mode", std::to_string(id))) return false;
+        defaultId = id;
+        return true;
+    }
+    bool hasPa() override { return call("has_pa"); }
+    bool getPaRanges(PaRanges* ranges) override {
+        *ranges = {{-180, 180, 1}, {-1, 1, 0.01}, {-1, 1, 0.01}, {-1, 1, 0.01}, {0, 1, 0.01}};
+        return call("get_pa_ranges");
+    }
+    bool getPa(PaValues* out) override {
+        *out = pa;
+        return call("get_pa");
+    }
+    bool setPa(const PaValues& values) override {
+        std::ostringstream args;
+        args << values;
+        if (!call("set_pa", args.str())) return false;
+        pa = values;
+        return true;
+    }
+
+  private:
+    bool call(const std::string& name, const std::string& args = "") {
+        bool ok = !failing.count(name);
+        std::cout << "  sdm " << name << (args.empty() ? "" : " ") << args
+                  << (ok ? "" : " FAILED") << "\n";
+        return ok;
+    }
+};
+
+bool ParsePa(const std::string& s, PaValues* pa) {
+    auto f = Split(s, ",");
+    if (f.size() != 5) return false;
+    char* end;
+    float v[5];
+    for (int i = 0; i < 5; i++) {
+        v[i] = strtof(f[i].c_str(), &end);
+        if (f[i].empty() || *end) return false;
+    }
+    *pa = {v[0], v[1], v[2], v[3], v[4]};
+    return true;
+}
+
+// Replays a script of the calls the livedisplay services make:
+//   mode <id> <name> <h,s,i,c,st>   adds a mode to the fake panel
+//   active <id>                     the daemon's active and default mode
+//   fail <sdm call>                 makes that call fail from now on
+//   get modes|mode|default|pa|default_pa
+//   set [mode=<id>] [default] [pa=<h,s,i,c,st>]
+bool Replay(std::istream& in, FakeSdmDisplay& fake, DisplayConfig& config) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string verb;
+        if (!(fields >> verb)) continue;
+        std::string a, b, c;
+        bool ok = true;
+        if (verb == "mode" && fields >> a >> b >> c) {
+            int32_t id;
+            PaValues pa;
+            ok = ParseInt(a, &id) && ParsePa(c, &pa);
+            if (ok) {
+                fake.modes.push_back({id, b});
+                fake.modePa.push_back(pa);
+            }
+        } else if (verb == "active" && fields >> a) {
+            ok = ParseInt(a, &fake.active);
+            fake.defaultId = fake.active;
+            for (size_t i = 0; ok && i < fake.modes.size(); i++) {
+                if (fake.modes[i].id == fake.active) fake.pa = fake.modePa[i];
+            }
+        } else if (verb == "fail" && fields >> a) {
+            fake.failing.insert(a);
+        } else if (verb == "get" && fields >> a) {
+            std::cout << line << "\n";
+            ModeInfo mode;
+            PaValues pa;
+            std::vector<ModeInfo> modes;
+            if (a == "modes" && config.modes(&modes)) {
+                for (const auto& m : modes) std::cout << "  = " << m.id << " " << m.name << "\n";
+            } else if ((a == "mode" && config.activeMode(&mode)) ||
+                       (a == "default" && config.defaultMode(&mode))) {
+                std::cout << "  = " << mode.id << " " << mode.name << "\n";
+            } else if ((a == "pa" && config.pa(&pa)) ||
+                       (a == "default_pa" && config.defaultPa(&pa))) {
+                std::cout << "  = " << pa << "\n";
+            } else {
+                std::cout << "  = error\n";
+            }
+        } else if (verb == "set") {
+            std::cout << line << "\n";
+            DisplayConfig::Change change;
+            while (ok && fields >> a) {
+                int32_t id;
+                PaValues pa;
+                if (a == "default") {
+                    change.makeDefault = true;
+                } else if (a.rfind("mode=", 0) == 0 && ParseInt(a.substr(5), &id)) {
+                    change.mode = id;
+                } else if (a.rfind("pa=", 0) == 0 && ParsePa(a.substr(3), &pa)) {
+                    change.pa = pa;
+                } else {
+                    ok = false;
+                }
+            }
+            if (ok) {
+                bool applied = config.apply(change);
+                std::cout << "  = " << (applied ? "ok" : "failed") << "\n";
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            LOG(ERROR) << "script line " << lineno << ": malformed " << verb;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SCRIPT\n", argv[0]);
+        return 1;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        PLOG(ERROR) << "Failed to open " << argv[1];
+        return 1;
+    }
+
+    FakeSdmDisplay fake;
+    DisplayConfig config(fake);
+    if (!Replay(in, fake, config)) return 1;
+    std::cout << config.queries() << " queries, " << config.sets() << " sets\n";
+    return 0;
+}
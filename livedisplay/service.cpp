@@ -21,6 +21,10 @@
 #include <hidl/HidlTransportSupport.h>
 
 #include "AntiFlicker.h"
+#include "DisplayConfig.h"
+#include "DisplayModes.h"
+#include "PictureAdjustment.h"
+#include "SdmControllerDisplay.h"
 #include "SunlightEnhancement.h"
 #include "livedisplay/sdm/SDMController.h"
 
@@ -32,11 +36,19 @@ using ::vendor::lineage::livedisplay::V2_0::sdm::SDMController;
 using ::vendor::lineage::livedisplay::V2_1::IAntiFlicker;
 using ::vendor::lineage::livedisplay::V2_1::ISunlightEnhancement;
 using ::vendor::lineage::livedisplay::V2_1::implementation::AntiFlicker;
+using ::vendor::lineage::livedisplay::V2_1::implementation::DisplayConfig;
+using ::vendor::lineage::livedisplay::V2_1::implementation::DisplayModes;
+using ::vendor::lineage::livedisplay::V2_1::implementation::PictureAdjustment;
+using ::vendor::lineage::livedisplay::V2_1::implementation::SdmControllerDisplay;
 using ::vendor::lineage::livedisplay::V2_1::implementation::SunlightEnhancement;
 
 int main() {
     status_t status = OK;
     std::shared_ptr<SDMController> controller = std::make_shared<SDMController>();
+    SdmControllerDisplay display(controller);
+    std::shared_ptr<DisplayConfig> config = std::make_shared<DisplayConfig>(display);
+    sp<DisplayModes> dm = new DisplayModes(config);
+    sp<PictureAdjustment> pa = new PictureAdjustment(config);
     sp<AntiFlicker> af = new AntiFlicker();
     sp<SunlightEnhancement> se = new SunlightEnhancement();
     android::hardware::configureRpcThreadpool(1, true /*callerWillJoin*/);
@@ -49,6 +61,26 @@ int main() {
         return 1;
     }
 
+    // DisplayModes service
+    if (dm->isSupported()) {
+        status = dm->registerAsService();
+        if (status != OK) {
+            LOG(ERROR) << "Could not register service for LiveDisplay HAL DisplayModes Iface ("
+                       << status << ")";
+            return 1;
+        }
+    }
+
+    // PictureAdjustment service
+    if (pa->isSupported()) {
+        status = pa->registerAsService();
+        if (status != OK) {
+            LOG(ERROR) << "Could not register service for LiveDisplay HAL PictureAdjustment Iface ("
+                       << status << ")";
+            return 1;
+        }
+    }
+
     // SunlightEnhancement service
     status = se->registerAsService();
     if (status != OK) {
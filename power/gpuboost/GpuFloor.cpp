@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.gpuboost"
+
+#include "GpuFloor.h"
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+
+using android::base::ParseUint;
+using android::base::ReadFileToString;
+using android::base::Trim;
+using android::base::WriteStringToFile;
+
+namespace vendor {
+namespace gpuboost {
+
+GpuFloor::GpuFloor(std::string path) : mPath(std::move(path)) {}
+
+uint64_t GpuFloor::read() const {
+    std::string content;
+    uint64_t hz;
+    if (!ReadFileToString(mPath, &content) || !ParseUint(Trim(content), &hz)) return 0;
+    return hz;
+}
+
+bool GpuFloor::write(uint64_t hz) {
+    if (!WriteStringToFile(std::to_string(hz), mPath)) {
+        PLOG(ERROR) << "Failed to write " << hz << " to " << mPath;
+        return false;
+    }
+    return true;
+}
+
+bool GpuFloor::raise(uint64_t hz) {
+    uint64_t current = read();
+    if (current == 0 || current >= hz || !write(hz)) return false;
+    mSaved = current;
+    mRaised = hz;
+    return true;
+}
+
+void GpuFloor::restore() {
+    if (mRaised == 0) return;
+    // The power HAL may have set its own floor meanwhile, which wins.
+    if (read() == mRaised) write(mSaved);
+    mRaised = 0;
+}
+
+}  // namespace gpuboost
+}  // namespace vendor
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace vendor {
+namespace gpuboost {
+
+// The GPU's devfreq min_freq, or a regular file standing in for it. The
+// power HAL writes the same node for its hints, so the floor is only
+// raised when it is lower and only put back while it still holds what
+// was written here.
+class GpuFloor {
+  public:
+    explicit GpuFloor(std::string path);
+
+    // Raises the floor to hz. False if it already was that high or the
+    // write failed, there is nothing to restore then.
+    bool raise(uint64_t hz);
+    // Puts back the floor raise() found, unless it was changed since.
+    void restore();
+
+    // What the node holds, 0 if it can't be read.
+    uint64_t read() const;
+
+  private:
+    bool write(uint64_t hz);
+
+    std::string mPath;
+    uint64_t mSaved = 0;
+    uint64_t mRaised = 0;
+};
+
+}  // namespace gpuboost
+}  // namespace vendor
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.gpuboost"
+
+#include "GpuPreBoost.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include <android-base/stringprintf.h>
+
+using android::base::StringPrintf;
+
+namespace vendor {
+namespace gpuboost {
+
+namespace {
+
+constexpr const char* kReleaseNames[] = {"frames", "idle", "cap"};
+
+}  // namespace
+
+GpuPreBoost::GpuPreBoost(GpuFloor& floor, const Params& params)
+    : mFloor(floor), mParams(params) {}
+
+void GpuPreBoost::touchDown(int64_t ns) {
+    expire(ns);
+    if (active()) {
+        // Another touch needs frames of its own, the floor stays.
+        mRetouched++;
+    } else {
+        mWindows++;
+        mRaised = mFloor.raise(mParams.boostHz);
+        if (!mRaised) mAlreadyHigh++;
+        mLastFrame = -1;
+    }
+    mStart = ns;
+    mFrames = 0;
+}
+
+void GpuPreBoost::frameDone(int64_t ns) {
+    expire(ns);
+    // A frame that completed before the touch did not answer it.
+    if (!active() || ns < mStart) return;
+    if (mFrames == 0) {
+        int bucket = std::min<int64_t>((ns - mStart) / kBucketNs, kBuckets - 1);
+        mFirstFrame[bucket]++;
+    }
+    mLastFrame = ns;
+    if (++mFrames >= mParams.frames) release(ns, kFrames);
+}
+
+int64_t GpuPreBoost::deadline() const {
+    int64_t idle = std::max(mStart, mLastFrame) + mParams.idleNs;
+    return std::min(idle, mStart + mParams.maxNs);
+}
+
+int64_t GpuPreBoost::expire(int64_t ns) {
+    if (!active()) return -1;
+    int64_t due = deadline();
+    if (due > ns) return due;
+    release(due, due == mStart + mParams.maxNs ? kCap : kIdle);
+    return -1;
+}
+
+void GpuPreBoost::release(int64_t ns, Release why) {
+    if (!active()) return;
+    if (mRaised) {
+        mFloor.restore();
+        // From the first touch of the window, retouches keep it raised.
+        mRaisedNs += ns - mStart;
+    }
+    mReleases[why]++;
+    mWindowFrames += mFrames;
+    mStart = -1;
+    mRaised = false;
+}
+
+void GpuPreBoost::dump(std::ostream& out) const {
+    out << StringPrintf("%d windows, %d retouched, %d with the floor already high\n", mWindows,
+                        mRetouched, mAlreadyHigh);
+    int closed = 0;
+    for (int i = 0; i < kReleases; i++) {
+        out << StringPrintf("  closed by %s: %d\n", kReleaseNames[i], mReleases[i]);
+        closed += mReleases[i];
+    }
+    if (closed) {
+        out << StringPrintf("  %.1f frames per window\n",
+                            static_cast<double>(mWindowFrames) / closed);
+    }
+    out << StringPrintf("floor raised for %" PRId64 "ms\n", mRaisedNs / 1000000);
+    out << "first frame after the touch:\n";
+    for (int i = 0; i < kBuckets; i++) {
+        if (!mFirstFrame[i]) continue;
+        int64_t from = i * kBucketNs / 1000000;
+        if (i == kBuckets - 1) {
+            out << StringPrintf("  >=%2" PRId64 "ms %d\n", from, mFirstFrame[i]);
+        } else {
+            out << StringPrintf("  %3" PRId64 "ms %d\n", from, mFirstFrame[i]);
+        }
+    }
+}
+
+}  // namespace gpuboost
+}  // namespace vendor
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+#include "GpuFloor.h"
+
+namespace vendor {
+namespace gpuboost {
+
+// Raises the GPU floor on touch down, ahead of the frames answering the
+// touch, which otherwise start on a GPU clocked down for idle and miss
+// their deadline while devfreq catches up. The window closes once that
+// many frames completed, not after a fixed time: as soon as the app
+// draws the GPU governor sees the load and ramps on its own. Without
+// frames the window closes when they stop coming, or after a cap. On
+// the device the frames are vblanks, see LiveSource.cpp, so there the
+// window is that many vblanks long once vsync runs.
+// Callers feed it timestamped events; it never reads the clock itself.
+class GpuPreBoost {
+  public:
+    struct Params {
+        // GPUMinFreq's second value, EXPENSIVE_RENDERING asks for the first.
+        uint64_t boostHz = 427000000;
+        // Frames completing after the touch that end the window.
+        int frames = 3;
+        // Ends the window with no frame this long after the touch or the
+        // last frame: the touch drew nothing, or no more.
+        int64_t idleNs = 100000000;
+        // Ends the window this long after the touch whatever happens.
+        int64_t maxNs = 500000000;
+    };
+
+    enum Release { kFrames, kIdle, kCap, kReleases };
+
+    // 4ms wide, the last one for anything later.
+    static constexpr int kBuckets = 17;
+    static constexpr int64_t kBucketNs = 4000000;
+
+    GpuPreBoost(GpuFloor& floor, const Params& params);
+
+    // A touch down, opens the window or starts it over.
+    void touchDown(int64_t ns);
+    // A frame completed at ns.
+    void frameDone(int64_t ns);
+    // Closes the window if it ran out by then. Returns when it will run
+    // out, or -1 with no window open.
+    int64_t expire(int64_t ns);
+
+    bool active() const { return mStart >= 0; }
+    // Closes the window, putting the floor back.
+    void release(int64_t ns, Release why);
+
+    // Windows, why they closed, their length and frames, and how long
+    // the first frame took after the touch.
+    void dump(std::ostream& out) const;
+
+  private:
+    int64_t deadline() const;
+
+    GpuFloor& mFloor;
+    const Params mParams;
+
+    // The open window: when its touch was, the last frame in it, the
+    // frames so far and whether the floor was raised for it.
+    int64_t mStart = -1;
+    int64_t mLastFrame = -1;
+    int mFrames = 0;
+    bool mRaised = false;
+
+    int mWindows = 0;
+    int mRetouched = 0;
+    int mAlreadyHigh = 0;
+    std::array<int, kReleases> mReleases = {};
+    int64_t mRaisedNs = 0;
+    int64_t mWindowFrames = 0;
+    std::array<int, kBuckets> mFirstFrame = {};
+};
+
+}  // namespace gpuboost
+}  // namespace vendor
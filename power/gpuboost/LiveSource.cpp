@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.gpuboost"
+
+#include "LiveSource.h"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/unique_fd.h>
+
+using android::base::ParseInt;
+using android::base::unique_fd;
+
+namespace vendor {
+namespace gpuboost {
+
+namespace {
+
+int64_t NowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// vsync_event holds "VSYNC=<ns>" of the last vblank. It advances on every
+// vblank while SurfaceFlinger or the composer keep vsync enabled, which
+// they do after a touch, whether or not a commit completed. The kernel
+// has no per-commit signal here, so the frames fed on the device are
+// vblanks.
+bool ReadVsync(int fd, int64_t* ns) {
+    char buf[64];
+    ssize_t len = TEMP_FAILURE_RETRY(pread(fd, buf, sizeof(buf) - 1, 0));
+    if (len <= 0) return false;
+    buf[len] = '\0';
+    std::string value(buf);
+    if (value.rfind("VSYNC=", 0) != 0) return false;
+    return ParseInt(value.substr(6, value.find('\n') - 6), ns);
+}
+
+}  // namespace
+
+bool RunLive(GpuPreBoost& boost, const std::string& touch, const std::string& vsync) {
+    unique_fd touchFd(TEMP_FAILURE_RETRY(open(touch.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (touchFd < 0) {
+        PLOG(ERROR) << "Failed to open " << touch;
+        return false;
+    }
+    // Event times on the clock vsync_event uses.
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(touchFd, EVIOCSCLOCKID, &clock)) PLOG(WARNING) << "EVIOCSCLOCKID";
+    unique_fd vsyncFd(TEMP_FAILURE_RETRY(open(vsync.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (vsyncFd < 0) {
+        PLOG(ERROR) << "Failed to open " << vsync;
+        return false;
+    }
+    int64_t lastVsync = 0;
+    // Reading arms sysfs_notify.
+    ReadVsync(vsyncFd, &lastVsync);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, nullptr);
+    unique_fd signalFd(signalfd(-1, &mask, SFD_CLOEXEC));
+
+    while (true) {
+        pollfd fds[] = {
+                {touchFd, POLLIN, 0},
+                {vsyncFd, POLLPRI | POLLERR, 0},
+                {signalFd, POLLIN, 0},
+        };
+        int64_t due = boost.expire(NowNs());
+        int timeout = due < 0 ? -1
+                              : static_cast<int>(
+                                        std::max<int64_t>((due - NowNs() + 999999) / 1000000, 0));
+        if (poll(fds, 3, timeout) < 0) continue;
+
+        if (fds[2].revents) {
+            // Stopped, the window counts as gone idle.
+            boost.release(NowNs(), GpuPreBoost::kIdle);
+            return true;
+        }
+        if (fds[0].revents & POLLIN) {
+            input_event events[64];
+            ssize_t size = TEMP_FAILURE_RETRY(read(touchFd, events, sizeof(events)));
+            for (ssize_t i = 0; i < size / static_cast<ssize_t>(sizeof(events[0])); i++) {
+                const input_event& ev = events[i];
+                if (ev.type == EV_KEY && ev.code == BTN_TOUCH && ev.value == 1) {
+                    boost.touchDown(ev.input_event_sec * 1000000000LL +
+                                    ev.input_event_usec * 1000LL);
+                }
+            }
+        }
+        if (fds[1].revents) {
+            int64_t ns;
+            if (ReadVsync(vsyncFd, &ns) && ns != lastVsync) {
+                lastVsync = ns;
+                boost.frameDone(ns);
+            }
+        }
+    }
+}
+
+}  // namespace gpuboost
+}  // namespace vendor
@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "GpuPreBoost.h"
+
+namespace vendor {
+namespace gpuboost {
+
+// Feeds touch downs from the touchscreen's evdev node and vblanks from
+// the display's vsync_event, as frames, until SIGTERM, which puts the
+// floor back.
+bool RunLive(GpuPreBoost& boost, const std::string& touch, const std::string& vsync);
+
+}  // namespace gpuboost
+}  // namespace vendor
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.gpuboost"
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+
+#include "GpuFloor.h"
+#include "GpuPreBoost.h"
+#ifdef __ANDROID__
+#include "LiveSource.h"
+#endif
+
+using android::base::ParseInt;
+using android::base::ParseUint;
+using android::base::WriteStringToFile;
+using vendor::gpuboost::GpuFloor;
+using vendor::gpuboost::GpuPreBoost;
+
+namespace {
+
+constexpr char kDefaultNode[] = "/sys/class/kgsl/kgsl-3d0/devfreq/min_freq";
+constexpr char kDefaultTouch[] = "/dev/input/event3";
+constexpr char kDefaultVsync[] =
+        "/sys/devices/platform/soc/ae00000.qcom,mdss_mdp/drm/card0/sde-crtc-0/vsync_event";
+
+struct Event {
+    int64_t ns;
+    std::string kind;
+    uint64_t value;
+};
+
+// Reads "<ms> touch", "<ms> frame", "<ms> frames COUNT PERIOD_US",
+// "<ms> floor HZ" (the power HAL writing the node) and "<ms> dump".
+bool ReadScript(std::istream& in, std::vector<Event>* events) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, kind, arg, arg2;
+        if (!(fields >> time)) continue;
+        int64_t ms;
+        bool ok = ParseInt(time, &ms, int64_t{0}) && fields >> kind;
+        if (ok && (kind == "touch" || kind == "frame" || kind == "dump")) {
+            events->push_back({ms * 1000000, kind, 0});
+        } else if (ok && kind == "frames") {
+            int count;
+            int64_t periodUs;
+            ok = fields >> arg >> arg2 && ParseInt(arg, &count, 1) &&
+                 ParseInt(arg2, &periodUs, int64_t{1});
+            for (int i = 0; ok && i < count; i++) {
+                events->push_back({ms * 1000000 + i * periodUs * 1000, "frame", 0});
+            }
+        } else if (ok && kind == "floor") {
+            uint64_t hz;
+            ok = fields >> arg && ParseUint(arg, &hz);
+            if (ok) events->push_back({ms * 1000000, kind, hz});
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            LOG(ERROR) << "replay line " << lineno << ": malformed event";
+            return false;
+        }
+    }
+    std::stable_sort(events->begin(), events->end(),
+                     [](const Event& a, const Event& b) { return a.ns < b.ns; });
+    return true;
+}
+
+// Replays the script against a fake node, printing when a window opens
+// and closes and what the node holds then.
+void Replay(const std::vector<Event>& events, GpuPreBoost& boost, GpuFloor& floor,
+            const std::string& node) {
+    bool active = false;
+    auto report = [&](int64_t ns) {
+        if (boost.active() == active) return;
+        active = boost.active();
+        printf("%.1f %s, floor %llu\n", ns / 1e6, active ? "opened" : "closed",
+               static_cast<unsigned long long>(floor.read()));
+    };
+
+    for (const Event& event : events) {
+        // A window that ran out in between, at the time it did.
+        int64_t due = boost.expire(0);
+        if (due >= 0 && due <= event.ns) {
+            boost.expire(due);
+            report(due);
+        }
+        if (event.kind == "touch") {
+            printf("%.1f touch\n", event.ns / 1e6);
+            boost.touchDown(event.ns);
+        } else if (event.kind == "frame") {
+            boost.frameDone(event.ns);
+        } else if (event.kind == "floor") {
+            WriteStringToFile(std::to_string(event.value), node);
+        } else if (event.kind == "dump") {
+            boost.dump(std::cout);
+        }
+        report(event.ns);
+    }
+}
+
+void Usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--boost-hz HZ] [--frames N] [--idle-ms MS] [--max-ms MS]\n"
+            "          [--node PATH] [--touch PATH] [--vsync PATH] [--replay FILE]\n",
+            name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    GpuPreBoost::Params params;
+    std::string node = kDefaultNode;
+    std::string touch = kDefaultTouch;
+    std::string vsync = kDefaultVsync;
+    std::string replay;
+
+    static const option options[] = {
+            {"boost-hz", required_argument, nullptr, 'b'},
+            {"frames", required_argument, nullptr, 'f'},
+            {"idle-ms", required_argument, nullptr, 'i'},
+            {"max-ms", required_argument, nullptr, 'm'},
+            {"node", required_argument, nullptr, 'n'},
+            {"touch", required_argument, nullptr, 't'},
+            {"vsync", required_argument, nullptr, 'v'},
+            {"replay", required_argument, nullptr, 'r'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    int64_t idleMs = params.idleNs / 1000000;
+    int64_t maxMs = params.maxNs / 1000000;
+    while ((opt = getopt_long(argc, argv, "b:f:i:m:n:t:v:r:", options, nullptr)) != -1) {
+        bool ok = true;
+        switch (opt) {
+            case 'b': ok = ParseUint(optarg, &params.boostHz); break;
+            case 'f': ok = ParseInt(optarg, &params.frames, 1); break;
+            case 'i': ok = ParseInt(optarg, &idleMs, int64_t{1}); break;
+            case 'm': ok = ParseInt(optarg, &maxMs, int64_t{1}); break;
+            case 'n': node = optarg; break;
+            case 't': touch = optarg; break;
+            case 'v': vsync = optarg; break;
+            case 'r': replay = optarg; break;
+            default: ok = false; break;
+        }
+        if (!ok) {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    params.idleNs = idleMs * 1000000;
+    params.maxNs = maxMs * 1000000;
+
+    GpuFloor floor(node);
+    GpuPreBoost boost(floor, params);
+
+    if (!replay.empty()) {
+        if (node == kDefaultNode) {
+            LOG(ERROR) << "Replaying needs --node, a file standing in for " << kDefaultNode;
+            return 1;
+        }
+        std::ifstream in(replay);
+        if (!in) {
+            PLOG(ERROR) << "Failed to open " << replay;
+            return 1;
+        }
+        std::vector<Event> events;
+        if (!ReadScript(in, &events)) return 1;
+        Replay(events, boost, floor, node);
+        return 0;
+    }
+
+#ifdef __ANDROID__
+    return vendor::gpuboost::RunLive(boost, touch, vsync) ? 0 : 1;
+#else
+    Usage(argv[0]);
+    return 1;
+#endif
+}
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Replay a power hint trace against the display idle timeout policy.
+
+  idlesim.py [--powerhint JSON] [--node NAME] [--fixed MS...] TRACE
+
+The power HAL resolves every powerhint.json node the way libperfmgr
+does: each active hint requests a value and the one listed first in the
+node's Values wins, with DefaultIndex when no hint is active. This
+replays TRACE through that for the display idle timeout node and feeds
+the result to a model of the encoder idle timer, which the driver arms
+with the current timeout on every frame and which takes the display to
+idle once it runs out before the next frame.
+
+TRACE has one event per line:
+
+  <ms> hint NAME [MS]        a boost or mode, for MS or the action durations
+  <ms> end NAME              ends a mode
+  <ms> frame [COUNT PERIOD]  a display update, or COUNT of them PERIOD ms apart
+  <ms> stop                  end of the trace
+
+For the policy and each --fixed timeout it reports the idle residency,
+how often the display went idle and how many frames had to wake it up
+while a hint was active, the ones that cost touch or launch latency.
+"""
+
+import argparse
+import heapq
+import json
+import os
+import sys
+
+DEFAULT_NODE = 'DisplayIdleTimeout'
+# What init used to write for good.
+DEFAULT_FIXED = [100]
+
+
+class Policy:
+    def __init__(self, path, node):
+        with open(path, 'r') as f:
+            config = json.load(f)
+        nodes = {n['Name']: n for n in config['Nodes']}
+        if node not in nodes:
+            sys.exit('%s: no node %s' % (path, node))
+        self.values = nodes[node]['Values']
+        self.default = nodes[node].get('DefaultIndex', 0)
+        # hint -> [(value index, duration ms)]
+        self.actions = {}
+        for action in config['Actions']:
+            if action.get('Node') != node:
+                continue
+            if action['Value'] not in self.values:
+                sys.exit('%s: %s sets %s to %s, not one of its values' %
+                         (path, action['PowerHint'], node, action['Value']))
+            self.actions.setdefault(action['PowerHint'], []).append(
+                (self.values.index(action['Value']), action.get('Duration', 0)))
+
+
+def load_trace(path):
+    events = []
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split('#')[0].split()
+            if not fields:
+                continue
+            try:
+                ms = int(fields[0])
+                kind = fields[1]
+                if kind == 'hint':
+                    events.append((ms, 'hint', fields[2], int(fields[3]) if len(fields) > 3 else None))
+                elif kind == 'end':
+                    events.append((ms, 'end', fields[2], None))
+                elif kind == 'frame':
+                    count, period = (int(fields[2]), int(fields[3])) if len(fields) > 2 else (1, 0)
+                    events.extend((ms + i * period, 'frame', None, None) for i in range(count))
+                elif kind == 'stop':
+                    events.append((ms, 'stop', None, None))
+                else:
+                    raise ValueError(kind)
+            except (IndexError, ValueError):
+                sys.exit('%s:%d: malformed event' % (path, lineno))
+    events.sort(key=lambda e: e[0])
+    if not events or events[-1][1] != 'stop':
+        sys.exit('%s: trace does not end with stop' % path)
+    return events
+
+
+class Result:
+    def __init__(self, name):
+        self.name = name
+        self.idle = 0
+        self.entries = 0
+        self.hinted_wakeups = 0
+        self.writes = 0
+        self.end = 0
+
+
+def simulate(events, timeout_at, hinted, name):
+    """timeout_at(ms) is the timeout in effect at ms, hinted(ms) whether a
+    hint that has an action on the node is active."""
+    result = Result(name)
+    last_frame = None
+    armed = None
+    for ms, kind, _, _ in events:
+        if kind not in ('frame', 'stop'):
+            continue
+        if last_frame is not None:
+            idle_from = last_frame + armed
+            if idle_from < ms:
+                result.idle += ms - idle_from
+                result.entries += 1
+                if kind == 'frame' and hinted(ms):
+                    result.hinted_wakeups += 1
+        if kind == 'stop':
+            result.end = ms
+            break
+        last_frame = ms
+        armed = timeout_at(ms)
+    return result
+
+
+def resolve(policy, events):
+    """Replays the hints; returns the node value change points and the
+    intervals some hint held a request on it."""
+    changes = [(0, policy.default)]
+    hinted = []
+    active = {}  # hint -> [(index, expiry or None)]
+    expiries = []
+
+    def value(now):
+        indexes = [index for requests in active.values()
+                   for index, expiry in requests if expiry is None or expiry > now]
+        return min(indexes) if indexes else policy.default
+
+    def record(now):
+        current = value(now)
+        if current != changes[-1][1]:
+            changes.append((now, current))
+        held = any(expiry is None or expiry > now
+                   for requests in active.values() for _, expiry in requests)
+        if held and (not hinted or hinted[-1][1] is not None):
+            hinted.append([now, None])
+        elif not held and hinted and hinted[-1][1] is None:
+            hinted[-1][1] = now
+
+    for ms, kind, hint, duration in events:
+        while expiries and expiries[0] <= ms:
+            expiry = heapq.heappop(expiries)
+            record(expiry)
+        if kind == 'hint' and hint in policy.actions:
+            requests = []
+            for index, action_duration in policy.actions[hint]:
+                length = duration if duration is not None else action_duration
+                expiry = ms + length if length else None
+                requests.append((index, expiry))
+                if expiry is not None:
+                    heapq.heappush(expiries, expiry)
+            active[hint] = requests
+            record(ms)
+        elif kind == 'end' and hint in active:
+            del active[hint]
+            record(ms)
+
+    return changes, hinted
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--powerhint', default=os.path.join(here, 'etc', 'powerhint.json'))
+    parser.add_argument('--node', default=DEFAULT_NODE)
+    parser.add_argument('--fixed', type=int, nargs='+', default=DEFAULT_FIXED, metavar='MS')
+    parser.add_argument('trace')
+    args = parser.parse_args()
+
+    policy = Policy(args.powerhint, args.node)
+    events = load_trace(args.trace)
+
+    changes, intervals = resolve(policy, events)
+
+    def timeout_at(ms):
+        current = policy.default
+        for when, index in changes:
+            if when > ms:
+                break
+            current = index
+        return int(policy.values[current])
+
+    def hinted(ms):
+        return any(start <= ms and (end is None or ms < end) for start, end in intervals)
+
+    results = [simulate(events, timeout_at, hinted, 'powerhint')]
+    results[0].writes = len(changes) - 1
+    for ms in args.fixed:
+        results.append(simulate(events, lambda _, ms=ms: ms, hinted, 'fixed %dms' % ms))
+
+    print('%s changes:' % args.node)
+    for when, index in changes:
+        print('  %8dms  %s' % (when, policy.values[index]))
+    print('%-12s %9s %8s %15s %7s' % ('policy', 'idle', 'entries', 'hinted wakeups', 'writes'))
+    for r in results:
+        print('%-12s %8.1f%% %8d %15d %7d' % (r.name, 100.0 * r.idle / r.end if r.end else 0,
+                                             r.entries, r.hinted_wakeups, r.writes))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
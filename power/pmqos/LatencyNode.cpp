@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.pmqos"
+
+#include "LatencyNode.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <android-base/logging.h>
+
+namespace vendor {
+namespace pmqos {
+
+LatencyNode::LatencyNode(std::string path) : mPath(std::move(path)) {}
+
+bool LatencyNode::set(int32_t us) {
+    if (mFd < 0) {
+        mFd.reset(TEMP_FAILURE_RETRY(open(mPath.c_str(), O_WRONLY | O_CLOEXEC)));
+        if (mFd < 0) {
+            PLOG(ERROR) << "Failed to open " << mPath;
+            return false;
+        }
+    }
+    if (TEMP_FAILURE_RETRY(pwrite(mFd, &us, sizeof(us), 0)) != sizeof(us)) {
+        PLOG(ERROR) << "Failed to write " << us << " to " << mPath;
+        return false;
+    }
+    return true;
+}
+
+void LatencyNode::clear() {
+    mFd.reset();
+}
+
+}  // namespace pmqos
+}  // namespace vendor
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <android-base/unique_fd.h>
+
+namespace vendor {
+namespace pmqos {
+
+// /dev/cpu_dma_latency, or a regular file standing in for it. The
+// kernel keeps a request for as long as the fd stays open, so the node
+// is opened with the first value and closed to drop the request. Values
+// are written as a binary s32. The kernel takes a 4 byte write as a raw
+// s32 before trying hex, so hex text of 0x1000-0xffff would be misread.
+class LatencyNode {
+  public:
+    explicit LatencyNode(std::string path);
+
+    bool set(int32_t us);
+    void clear();
+
+  private:
+    std::string mPath;
+    android::base::unique_fd mFd;
+};
+
+}  // namespace pmqos
+}  // namespace vendor
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "PmQosClient.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+
+using android::base::ParseInt;
+using android::base::StringPrintf;
+
+namespace vendor {
+namespace pmqos {
+
+namespace {
+
+// Fits the dump of a few dozen clients.
+constexpr size_t kMaxReply = 16384;
+
+}  // namespace
+
+bool PmQosClient::connect(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mLock);
+    android::base::unique_fd sock(socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0));
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (sock < 0 || ::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+        return false;
+    }
+    mSock = std::move(sock);
+    return true;
+}
+
+bool PmQosClient::request(const std::string& message, std::string* reply) {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mSock < 0) return false;
+    if (TEMP_FAILURE_RETRY(send(mSock, message.data(), message.size(), MSG_NOSIGNAL)) < 0) {
+        return false;
+    }
+    reply->resize(kMaxReply);
+    ssize_t size = TEMP_FAILURE_RETRY(recv(mSock, reply->data(), reply->size(), 0));
+    if (size <= 0) return false;
+    reply->resize(size);
+    return *reply != "error";
+}
+
+int PmQosClient::vote(const std::string& client, int32_t us, int64_t timeoutMs) {
+    std::string reply;
+    int id;
+    if (!request(StringPrintf("vote %s %d %lld", client.c_str(), us, (long long)timeoutMs),
+                 &reply) ||
+        !ParseInt(reply, &id)) {
+        return -1;
+    }
+    return id;
+}
+
+bool PmQosClient::release(int id) {
+    std::string reply;
+    return request(StringPrintf("release %d", id), &reply);
+}
+
+std::string PmQosClient::dump() {
+    std::string reply;
+    return request("dump", &reply) ? reply : "";
+}
+
+}  // namespace pmqos
+}  // namespace vendor
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <android-base/unique_fd.h>
+
+namespace vendor {
+namespace pmqos {
+
+// init creates it for vendor.pmqos, see the rc file.
+constexpr char kSocketName[] = "pmqos";
+constexpr char kSocketPath[] = "/dev/socket/pmqos";
+
+// Requests on the socket, one per packet, each answered with one:
+//   vote <client> <us> <timeout ms>   -> <id>, timeout 0 until released
+//   release <id>                      -> ok
+//   dump                              -> the service state
+// Failures are answered with "error". Votes end with the connection.
+// Client names have no spaces, they key the residency in the dump.
+
+// A connection to vendor.pmqos. Votes last as long as the client keeps
+// it, so keep one for the process rather than one per vote.
+class PmQosClient {
+  public:
+    bool connect(const std::string& path = kSocketPath);
+
+    // Returns the vote id, or -1.
+    int vote(const std::string& client, int32_t us, int64_t timeoutMs = 0);
+    bool release(int id);
+    std::string dump();
+
+  private:
+    bool request(const std::string& message, std::string* reply);
+
+    std::mutex mLock;
+    android::base::unique_fd mSock;
+};
+
+// Holds a vote for its lifetime.
+class ScopedLatencyVote {
+  public:
+    ScopedLatencyVote(PmQosClient& client, const std::string& name, int32_t us)
+        : mClient(client), mId(client.vote(name, us)) {}
+    ~ScopedLatencyVote() {
+        if (mId >= 0) mClient.release(mId);
+    }
+    ScopedLatencyVote(const ScopedLatencyVote&) = delete;
+    ScopedLatencyVote& operator=(const ScopedLatencyVote&) = delete;
+
+    bool held() const { return mId >= 0; }
+
+  private:
+    PmQosClient& mClient;
+    int mId;
+};
+
+}  // namespace pmqos
+}  // namespace vendor
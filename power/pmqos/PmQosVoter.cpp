@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.pmqos"
+
+#include "PmQosVoter.h"
+
+#include <cinttypes>
+#include <set>
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+
+using android::base::StringPrintf;
+
+namespace vendor {
+namespace pmqos {
+
+PmQosVoter::PmQosVoter(LatencyNode& node) : mNode(node) {}
+
+int PmQosVoter::vote(int64_t ms, int connection, const std::string& client, int32_t us,
+                     int64_t timeoutMs) {
+    if (us < 0 || timeoutMs < 0 || client.empty()) return -1;
+    expire(ms);
+    mClients[client].votes++;
+    if (timeoutMs == 0) {
+        for (auto& [id, vote] : mVotes) {
+            if (vote.connection == connection && vote.client == client && vote.us == us &&
+                vote.expiry < 0) {
+                vote.refs++;
+                return id;
+            }
+        }
+    }
+    int id = mNextId++;
+    mVotes[id] = {connection, client, us, timeoutMs ? ms + timeoutMs : -1, 1};
+    update();
+    return id;
+}
+
+bool PmQosVoter::release(int64_t ms, int connection, int id) {
+    expire(ms);
+    auto it = mVotes.find(id);
+    if (it == mVotes.end() || it->second.connection != connection) return false;
+    if (--it->second.refs == 0) {
+        mVotes.erase(it);
+        update();
+    }
+    return true;
+}
+
+void PmQosVoter::disconnect(int64_t ms, int connection) {
+    expire(ms);
+    for (auto it = mVotes.begin(); it != mVotes.end();) {
+        it = it->second.connection == connection ? mVotes.erase(it) : std::next(it);
+    }
+    update();
+}
+
+int64_t PmQosVoter::expire(int64_t ms) {
+    while (true) {
+        auto due = mVotes.end();
+        for (auto it = mVotes.begin(); it != mVotes.end(); ++it) {
+            int64_t expiry = it->second.expiry;
+            if (expiry >= 0 && (due == mVotes.end() || expiry < due->second.expiry)) due = it;
+        }
+        if (due == mVotes.end()) {
+            account(ms);
+            return -1;
+        }
+        if (due->second.expiry > ms) {
+            account(ms);
+            return due->second.expiry;
+        }
+        // Account up to the expiry, so the residency is exact however
+        // late this runs.
+        account(due->second.expiry);
+        mVotes.erase(due);
+        update();
+    }
+}
+
+void PmQosVoter::account(int64_t ms) {
+    int64_t elapsed = ms - mAccounted;
+    if (elapsed <= 0) return;
+    mAccounted = ms;
+    std::set<std::string> voted, deciding;
+    for (const auto& [id, vote] : mVotes) {
+        voted.insert(vote.client);
+        if (vote.us == mApplied) deciding.insert(vote.client);
+    }
+    for (const auto& client : voted) mClients[client].votedMs += elapsed;
+    for (const auto& client : deciding) mClients[client].decidingMs += elapsed;
+    if (mApplied >= 0) mValueMs[mApplied] += elapsed;
+}
+
+void PmQosVoter::update() {
+    int32_t strictest = -1;
+    for (const auto& [id, vote] : mVotes) {
+        if (strictest < 0 || vote.us < strictest) strictest = vote.us;
+    }
+    if (strictest == mApplied) return;
+    if (strictest < 0) {
+        mNode.clear();
+    } else if (!mNode.set(strictest)) {
+        // Keep the old request, if any; the next change tries again.
+        return;
+    }
+    if (strictest < 0) {
+        LOG(INFO) << "cpu_dma_latency released";
+    } else {
+        LOG(INFO) << "cpu_dma_latency " << strictest << "us";
+    }
+    mApplied = strictest;
+}
+
+void PmQosVoter::dump(std::ostream& out, int64_t ms) {
+    expire(ms);
+    out << (mApplied < 0 ? std::string("no request") : StringPrintf("applied %dus", mApplied))
+        << "\n";
+    out << "votes:\n";
+    for (const auto& [id, vote] : mVotes) {
+        out << StringPrintf("  #%d %s %dus refs %d connection %d", id, vote.client.c_str(),
+                            vote.us, vote.refs, vote.connection);
+        if (vote.expiry >= 0) out << StringPrintf(" for %" PRId64 "ms", vote.expiry - ms);
+        out << "\n";
+    }
+    out << "clients:\n";
+    for (const auto& [client, residency] : mClients) {
+        out << StringPrintf("  %s %d votes, voted %" PRId64 "ms, deciding %" PRId64 "ms\n",
+                            client.c_str(), residency.votes, residency.votedMs,
+                            residency.decidingMs);
+    }
+    out << "values:\n";
+    for (const auto& [us, total] : mValueMs) {
+        out << StringPrintf("  %6dus %" PRId64 "ms\n", us, total);
+    }
+}
+
+}  // namespace pmqos
+}  // namespace vendor
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+#include "LatencyNode.h"
+
+namespace vendor {
+namespace pmqos {
+
+// Collects CPU DMA latency votes and keeps the strictest one applied to
+// the node, or no request at all without votes. A vote belongs to the
+// connection it came in on and goes away with it, so a client that dies
+// can't leave deep idle blocked. Callers feed it timestamps; it never
+// reads the clock itself.
+class PmQosVoter {
+  public:
+    explicit PmQosVoter(LatencyNode& node);
+
+    // Votes for at most us of wakeup latency until released, or for
+    // timeoutMs if that is not 0. The same client voting the same value
+    // again on a connection takes another reference on the vote it has.
+    // Returns the vote id, or -1 for an invalid vote.
+    int vote(int64_t ms, int connection, const std::string& client, int32_t us,
+             int64_t timeoutMs);
+    // Drops a reference, the vote ends with the last one.
+    bool release(int64_t ms, int connection, int id);
+    // Ends every vote of the connection.
+    void disconnect(int64_t ms, int connection);
+
+    // Ends the timed votes due by then. Returns when the next one is due,
+    // or -1 if none is timed.
+    int64_t expire(int64_t ms);
+
+    // The latency requested from the kernel, -1 for none.
+    int32_t applied() const { return mApplied; }
+
+    // The votes, how long each client had one and decided the applied
+    // value, and how long each value was applied.
+    void dump(std::ostream& out, int64_t ms);
+
+  private:
+    struct Vote {
+        int connection;
+        std::string client;
+        int32_t us;
+        int64_t expiry;
+        int refs;
+    };
+    struct Residency {
+        int64_t votedMs = 0;
+        int64_t decidingMs = 0;
+        int votes = 0;
+    };
+
+    void account(int64_t ms);
+    void update();
+
+    LatencyNode& mNode;
+    std::map<int, Vote> mVotes;
+    int mNextId = 1;
+    int32_t mApplied = -1;
+    int64_t mAccounted = 0;
+    std::map<std::string, Residency> mClients;
+    std::map<int32_t, int64_t> mValueMs;
+};
+
+}  // namespace pmqos
+}  // namespace vendor
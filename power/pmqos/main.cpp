@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.pmqos"
+
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/unique_fd.h>
+#ifdef __ANDROID__
+#include <cutils/sockets.h>
+#endif
+
+#include "LatencyNode.h"
+#include "PmQosClient.h"
+#include "PmQosVoter.h"
+
+using android::base::ParseInt;
+using android::base::ReadFileToString;
+using android::base::unique_fd;
+using vendor::pmqos::LatencyNode;
+using vendor::pmqos::PmQosVoter;
+
+namespace {
+
+constexpr char kDefaultNode[] = "/dev/cpu_dma_latency";
+constexpr size_t kMaxRequest = 256;
+
+// Answers one request of the socket protocol, see PmQosClient.h.
+std::string Handle(PmQosVoter& voter, int64_t ms, int connection, const std::string& request) {
+    std::istringstream fields(request);
+    std::string verb;
+    fields >> verb;
+    if (verb == "vote") {
+        std::string client, us, timeout;
+        int32_t value;
+        int64_t timeoutMs;
+        if (fields >> client >> us >> timeout && ParseInt(us, &value) &&
+            ParseInt(timeout, &timeoutMs)) {
+            int id = voter.vote(ms, connection, client, value, timeoutMs);
+            if (id >= 0) return std::to_string(id);
+        }
+    } else if (verb == "release") {
+        std::string id;
+        int value;
+        if (fields >> id && ParseInt(id, &value) && voter.release(ms, connection, value)) {
+            return "ok";
+        }
+    } else if (verb == "dump") {
+        std::ostringstream out;
+        voter.dump(out, ms);
+        return out.str();
+    }
+    return "error";
+}
+
+// Replays "<ms> <connection> <request>" and "<ms> <connection> disconnect"
+// lines against a fake node, printing each answer and every change of
+// the node.
+bool Replay(std::istream& in, PmQosVoter& voter, const std::string& node) {
+    int32_t applied = -1;
+    auto report = [&](int64_t ms) {
+        if (voter.applied() == applied) return;
+        applied = voter.applied();
+        std::string content;
+        ReadFileToString(node, &content);
+        int32_t held = -1;
+        if (content.size() == sizeof(held)) memcpy(&held, content.data(), sizeof(held));
+        if (applied < 0) {
+            std::cout << ms << " released\n";
+        } else {
+            std::cout << ms << " applied " << applied << "us, node holds " << held << "\n";
+        }
+    };
+
+    std::string line;
+    int lineno = 0;
+    int64_t ms = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, connection;
+        if (!(fields >> time)) continue;
+        int64_t next;
+        int conn;
+        if (!ParseInt(time, &next, ms) || !(fields >> connection) || !ParseInt(connection, &conn)) {
+            LOG(ERROR) << "replay line " << lineno << ": malformed event";
+            return false;
+        }
+        // Timed votes that ran out in between.
+        int64_t due = voter.expire(ms);
+        while (due >= 0 && due <= next) {
+            int64_t at = due;
+            due = voter.expire(at);
+            report(at);
+        }
+        ms = next;
+
+        std::string request;
+        std::getline(fields >> std::ws, request);
+        if (request == "disconnect") {
+            voter.disconnect(ms, conn);
+        } else {
+            std::string reply = Handle(voter, ms, conn, request);
+            std::cout << ms << " " << conn << " " << request << ": " << reply
+                      << (request == "dump" ? "" : "\n");
+        }
+        report(ms);
+    }
+    return true;
+}
+
+#ifdef __ANDROID__
+int64_t NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void Serve(int sock, PmQosVoter& voter) {
+    std::vector<unique_fd> clients;
+    while (true) {
+        std::vector<pollfd> fds = {{sock, POLLIN, 0}};
+        for (const auto& client : clients) fds.push_back({client.get(), POLLIN, 0});
+        int64_t due = voter.expire(NowMs());
+        int timeout = due < 0 ? -1 : static_cast<int>(std::max<int64_t>(due - NowMs(), 0));
+        if (poll(fds.data(), fds.size(), timeout) < 0) continue;
+
+        int64_t ms = NowMs();
+        for (size_t i = fds.size() - 1; i > 0; i--) {
+            if (!fds[i].revents) continue;
+            std::string request(kMaxRequest, '\0');
+            ssize_t size = TEMP_FAILURE_RETRY(recv(fds[i].fd, request.data(), request.size(), 0));
+            if (size <= 0) {
+                // The connection's votes end with it.
+                voter.disconnect(ms, fds[i].fd);
+                clients.erase(clients.begin() + i - 1);
+                continue;
+            }
+            request.resize(size);
+            std::string reply = Handle(voter, ms, fds[i].fd, request);
+            TEMP_FAILURE_RETRY(send(fds[i].fd, reply.data(), reply.size(), MSG_NOSIGNAL));
+        }
+        if (fds[0].revents & POLLIN) {
+            unique_fd client(accept4(sock, nullptr, nullptr, SOCK_CLOEXEC));
+            if (client >= 0) clients.push_back(std::move(client));
+        }
+    }
+}
+#endif
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--node PATH] [--replay FILE]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string node = kDefaultNode;
+    std::string replay;
+
+    static const option options[] = {
+            {"node", required_argument, nullptr, 'n'},
+            {"replay", required_argument, nullptr, 'r'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:r:", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'n': node = optarg; break;
+            case 'r': replay = optarg; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    LatencyNode latency(node);
+    PmQosVoter voter(latency);
+
+    if (!replay.empty()) {
+        if (node == kDefaultNode) {
+            LOG(ERROR) << "Replaying needs --node, a file standing in for " << kDefaultNode;
+            return 1;
+        }
+        std::ifstream in(replay);
+        if (!in) {
+            PLOG(ERROR) << "Failed to open " << replay;
+            return 1;
+        }
+        return Replay(in, voter, node) ? 0 : 1;
+    }
+
+#ifdef __ANDROID__
+    int sock = android_get_control_socket(vendor::pmqos::kSocketName);
+    if (sock < 0 || listen(sock, 8)) {
+        PLOG(ERROR) << "No control socket " << vendor::pmqos::kSocketName;
+        return 1;
+    }
+    Serve(sock, voter);
+    return 1;
+#else
+    Usage(argv[0]);
+    return 1;
+#endif
+}
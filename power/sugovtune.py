@@ -0,0 +1,491 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Tune the schedutil rate limits of each CPU cluster against a trace.
+
+  sugovtune.py [--up US...] [--down US...] [--max-late N] [--min-saving MA]
+               [--ftrace [--deadline MS] [--frame-comm COMM...]] TRACE
+
+Replays TRACE through a model of schedutil on each cluster, once per
+pair of candidate rate limits: the cluster's utilization follows the
+demand on its busiest CPU with a short half-life, schedutil asks for the
+lowest frequency with 25% headroom over it and only changes frequency
+once up_rate_limit_us (to go up) or down_rate_limit_us (to go down)
+passed since the last change. Frame work runs at whatever frequency that
+gives, so a slow ramp makes frames late and a slow drop burns power.
+
+The frequencies and the energy proxy come from the power_profile.xml
+overlay: cluster power plus, for each busy core, the active and core
+power at the current frequency, as average mA. The current settings are
+read from init.target.rc.
+
+For each cluster the candidates are listed with the frames the cluster
+made late and the energy; the pick is the cheapest one that is late at
+most --max-late more often than the current setting. The model's energy
+is not good to a fraction of a mA, so a pick must also save at least
+--min-saving mA (0.5) over the current setting, or the current setting
+stays. The picks are
+checked together, frame misses and input to frame latency, and printed
+as init.target.rc commands.
+
+TRACE has one event per line, clusters named as in power_profile.xml:
+
+  <ms> load CLUSTER MHZ                      background demand from now on
+  <ms> frame DEADLINE CLUSTER:MCYCLES...     a frame and its work per cluster
+  <ms> frames COUNT PERIOD DEADLINE CLUSTER:MCYCLES...
+                                             COUNT frames PERIOD ms apart
+  <ms> input                                 a touch, the next frame answers it
+  <ms> stop                                  end of the trace
+
+With --ftrace, TRACE is the text of an ftrace capture instead, as read
+from /sys/kernel/tracing/trace or converted from perfetto with
+"traceconv systrace". It needs the sched_switch and cpu_frequency
+events, and the atrace markers of the gfx and input categories if
+there are any:
+
+  - A frame starts at each Choreographer#doFrame marker. Without
+    markers, a frame starts whenever a frame thread runs after all of
+    them slept for 2ms. A frame's deadline is --deadline ms (16).
+  - Frame threads are the threads that mark doFrame and those named
+    --frame-comm (RenderThread). The cycles they run until the next
+    frame starts are the frame's work on each cluster.
+  - Everything else is background load: the cycles the busiest CPU of
+    the cluster ran in each 20ms window.
+  - A deliverInputEvent marker is an input.
+
+Cycles are time on the CPU at the cluster's frequency from the last
+cpu_frequency event. Before the first event, the cluster is taken to
+run at its first reported frequency, or its highest without any.
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+DEFAULT_UP = [0, 500, 1000, 2000, 5000]
+DEFAULT_DOWN = [1000, 5000, 10000, 20000, 40000]
+
+# schedutil asks for util * 1.25 of the maximum frequency.
+HEADROOM = 1.25
+# A rough stand-in for WALT's 20ms windows.
+HALFLIFE_MS = 8.0
+STEP_MS = 0.25
+
+# Background load is averaged over windows of this size, as WALT does.
+WINDOW_MS = 20.0
+# Without doFrame markers, frame threads asleep this long end a frame.
+FRAME_GAP_MS = 2.0
+
+FTRACE_LINE = re.compile(r'^\s*(?P<task>.+?)-(?P<tid>\d+)\s+(?:\(\s*[\d-]+\)\s+)?'
+                         r'\[(?P<cpu>\d+)\]\s+(?:\S+\s+)?(?P<ts>\d+\.\d+):\s+'
+                         r'(?P<event>\w+):\s+(?P<args>.*)$')
+SCHED_SWITCH = re.compile(r'prev_comm=.*? prev_pid=(\d+) .*==> '
+                          r'next_comm=(.*?) next_pid=(\d+)')
+CPU_FREQUENCY = re.compile(r'state=(\d+) cpu_id=(\d+)')
+MARKER = re.compile(r'B\|\d+\|(Choreographer#doFrame|deliverInputEvent)')
+
+RATE_LIMIT = re.compile(r'write /sys/devices/system/cpu/cpu(\d+)/cpufreq/schedutil/'
+                        r'(up|down)_rate_limit_us (\d+)')
+
+
+class Cluster:
+    def __init__(self, name, first_cpu, cores, freqs, core_power, cluster_power, active):
+        self.name = name
+        self.first_cpu = first_cpu
+        self.cores = cores
+        self.freqs = [f / 1000.0 for f in freqs]  # MHz
+        self.core_power = core_power
+        self.cluster_power = cluster_power
+        self.active = active
+        self.up = None
+        self.down = None
+
+
+def load_clusters(path):
+    root = ET.parse(path).getroot()
+    items = {e.get('name'): float(e.text) for e in root.iter('item')}
+    arrays = {e.get('name'): [float(v.text) for v in e.iter('value')] for e in root.iter('array')}
+    clusters = []
+    first = 0
+    for i, cores in enumerate(arrays['cpu.clusters.cores']):
+        name = 'cluster%d' % i
+        clusters.append(Cluster(name, first, int(cores),
+                                arrays['cpu.core_speeds.' + name],
+                                arrays['cpu.core_power.' + name],
+                                items.get('cpu.cluster_power.' + name, 0),
+                                items.get('cpu.active', 0)))
+        first += int(cores)
+    return clusters
+
+
+def load_current(path, clusters):
+    by_cpu = {c.first_cpu: c for c in clusters}
+    with open(path, 'r') as f:
+        for match in RATE_LIMIT.finditer(f.read()):
+            cluster = by_cpu.get(int(match.group(1)))
+            if cluster:
+                setattr(cluster, match.group(2), int(match.group(3)))
+
+
+def parse_work(fields, names):
+    work = {}
+    for field in fields:
+        name, _, mcycles = field.partition(':')
+        if name not in names:
+            raise ValueError(name)
+        work[name] = float(mcycles)
+    return work
+
+
+def load_trace(path, names):
+    frames = []  # (start, deadline, {cluster: mcycles})
+    loads = []  # (ms, cluster, mhz)
+    inputs = []
+    end = None
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split('#')[0].split()
+            if not fields:
+                continue
+            try:
+                ms = float(fields[0])
+                kind = fields[1]
+                if kind == 'load':
+                    if fields[2] not in names:
+                        raise ValueError(fields[2])
+                    loads.append((ms, fields[2], float(fields[3])))
+                elif kind == 'frame':
+                    frames.append((ms, float(fields[2]), parse_work(fields[3:], names)))
+                elif kind == 'frames':
+                    count, period, deadline = int(fields[2]), float(fields[3]), float(fields[4])
+                    work = parse_work(fields[5:], names)
+                    frames.extend((ms + i * period, deadline, work) for i in range(count))
+                elif kind == 'input':
+                    inputs.append(ms)
+                elif kind == 'stop':
+                    end = ms
+                else:
+                    raise ValueError(kind)
+            except (IndexError, ValueError):
+                sys.exit('%s:%d: malformed event' % (path, lineno))
+    if end is None:
+        sys.exit('%s: trace does not end with stop' % path)
+    frames.sort(key=lambda f: f[0])
+    loads.sort(key=lambda l: l[0])
+    return frames, loads, sorted(inputs), end
+
+
+def read_ftrace(path):
+    events = []  # (seconds, cpu, tid, event, args)
+    with open(path, 'r') as f:
+        for line in f:
+            match = FTRACE_LINE.match(line)
+            if match and match.group('event') in ('sched_switch', 'cpu_frequency',
+                                                  'tracing_mark_write'):
+                events.append((float(match.group('ts')), int(match.group('cpu')),
+                               int(match.group('tid')), match.group('event'),
+                               match.group('args')))
+    if not events:
+        sys.exit('%s: no sched_switch, cpu_frequency or marker events' % path)
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+def import_ftrace(path, clusters, deadline, frame_comms):
+    """Turns an ftrace capture into the frames, loads and inputs of a trace."""
+    events = read_ftrace(path)
+    start = events[0][0]
+    end = (events[-1][0] - start) * 1000.0
+
+    by_cpu = {}
+    for cluster in clusters:
+        for cpu in range(cluster.first_cpu, cluster.first_cpu + cluster.cores):
+            by_cpu[cpu] = cluster
+    mhz = {}
+    for _, _, _, event, args in events:
+        match = CPU_FREQUENCY.match(args) if event == 'cpu_frequency' else None
+        if match and int(match.group(2)) in by_cpu:
+            mhz.setdefault(by_cpu[int(match.group(2))].name, int(match.group(1)) / 1000.0)
+    for cluster in clusters:
+        mhz.setdefault(cluster.name, cluster.freqs[-1])
+
+    frame_tids = set()
+    markers = []  # (ms, kind)
+    for ts, _, tid, event, args in events:
+        match = MARKER.match(args) if event == 'tracing_mark_write' else None
+        if match:
+            markers.append(((ts - start) * 1000.0, match.group(1)))
+            if match.group(1) == 'Choreographer#doFrame':
+                frame_tids.add(tid)
+    frame_starts = [ms for ms, kind in markers if kind == 'Choreographer#doFrame']
+    inputs = [ms for ms, kind in markers if kind == 'deliverInputEvent']
+
+    frames = []  # [start, deadline, {cluster: mcycles}]
+    background = {}  # (cluster, cpu, window) -> mcycles
+    running = {}  # cpu -> (tid, is frame thread, since ms)
+    frame_running = set()
+    frame_idle_since = 0.0
+
+    def frame_at(ms):
+        while frame_starts and frame_starts[0] <= ms:
+            frames.append([frame_starts.pop(0), deadline, {}])
+        return frames[-1] if frames else None
+
+    def account(cpu, ms):
+        tid, is_frame, since = running.get(cpu, (0, False, ms))
+        running[cpu] = (tid, is_frame, ms)
+        cluster = by_cpu.get(cpu)
+        if not tid or not cluster or ms <= since:
+            return
+        rate = mhz[cluster.name] / 1000.0  # mcycles per ms
+        frame = frame_at(since) if is_frame else None
+        if frame:
+            work = frame[2]
+            work[cluster.name] = work.get(cluster.name, 0.0) + (ms - since) * rate
+            return
+        t = since
+        while t < ms:
+            window = int(t // WINDOW_MS)
+            upto = min(ms, (window + 1) * WINDOW_MS)
+            key = (cluster.name, cpu, window)
+            background[key] = background.get(key, 0.0) + (upto - t) * rate
+            t = upto
+
+    for ts, cpu, _, event, args in events:
+        ms = (ts - start) * 1000.0
+        if event == 'cpu_frequency':
+            match = CPU_FREQUENCY.match(args)
+            cluster = match and by_cpu.get(int(match.group(2)))
+            if cluster:
+                for other in range(cluster.first_cpu, cluster.first_cpu + cluster.cores):
+                    account(other, ms)
+                mhz[cluster.name] = int(match.group(1)) / 1000.0
+        elif event == 'tracing_mark_write':
+            # Work up to a frame start belongs to the frame before it.
+            if frame_starts and frame_starts[0] <= ms:
+                for other in list(running):
+                    account(other, ms)
+        elif event == 'sched_switch':
+            match = SCHED_SWITCH.match(args)
+            if not match:
+                continue
+            account(cpu, ms)
+            comm, tid = match.group(2), int(match.group(3))
+            is_frame = tid in frame_tids or comm in frame_comms
+            if is_frame and not markers and not frame_running and \
+                    ms - frame_idle_since >= FRAME_GAP_MS:
+                frames.append([ms, deadline, {}])
+            if is_frame:
+                frame_running.add(cpu)
+            elif cpu in frame_running:
+                frame_running.discard(cpu)
+                if not frame_running:
+                    frame_idle_since = ms
+            running[cpu] = (tid, is_frame, ms)
+    for cpu in list(running):
+        account(cpu, end)
+    frame_at(end)
+
+    loads = []
+    for cluster in clusters:
+        last = None
+        for window in range(int(end // WINDOW_MS) + 1):
+            cycles = max(background.get((cluster.name, cpu, window), 0.0)
+                         for cpu in range(cluster.first_cpu, cluster.first_cpu + cluster.cores))
+            demand = round(cycles / WINDOW_MS * 1000.0)
+            if demand != last:
+                loads.append((window * WINDOW_MS, cluster.name, float(demand)))
+                last = demand
+    frames = [(start, deadline, work) for start, deadline, work in frames if work]
+    loads.sort(key=lambda l: l[0])
+    return frames, loads, inputs, end
+
+
+class Run:
+    def __init__(self, up, down):
+        self.up = up
+        self.down = down
+        self.finish = []  # per frame, None if the cluster had no work in it
+        self.late = 0
+        self.energy = 0.0  # mA * ms
+        self.changes = 0
+
+
+def simulate(cluster, frames, loads, end, up_us, down_us):
+    run = Run(up_us, down_us)
+    parts = [(i, start, deadline, work[cluster.name])
+             for i, (start, deadline, work) in enumerate(frames) if cluster.name in work]
+    run.finish = [None] * len(frames)
+    loads = [(ms, mhz) for ms, name, mhz in loads if name == cluster.name]
+
+    freqs = cluster.freqs
+    fmax = freqs[-1]
+    decay = 1 - 0.5 ** (STEP_MS / HALFLIFE_MS)
+    up_ms, down_ms = up_us / 1000.0, down_us / 1000.0
+
+    f = freqs[0]
+    index = 0
+    last_change = -1e9
+    util = 0.0
+    background = 0.0
+    queue = []  # [frame index, remaining mcycles]
+    next_part = 0
+    next_load = 0
+    t = 0.0
+    while t < end:
+        while next_load < len(loads) and loads[next_load][0] <= t:
+            background = loads[next_load][1]
+            next_load += 1
+        while next_part < len(parts) and parts[next_part][1] <= t:
+            queue.append([next_part, parts[next_part][3]])
+            next_part += 1
+
+        # Frame work runs on one CPU, serially, background load on another.
+        budget = f * STEP_MS / 1000.0
+        busy_frame = 0.0
+        while queue and budget > 0:
+            done = min(budget, queue[0][1])
+            queue[0][1] -= done
+            budget -= done
+            busy_frame += done
+            if queue[0][1] <= 1e-9:
+                i, start, deadline, _ = parts[queue[0][0]]
+                finish = t + STEP_MS * busy_frame / (f * STEP_MS / 1000.0)
+                run.finish[i] = finish
+                if finish > start + deadline:
+                    run.late += 1
+                queue.pop(0)
+        busy_frame /= f * STEP_MS / 1000.0
+        busy_background = min(1.0, background / f)
+
+        busy = min(cluster.cores, busy_frame + busy_background)
+        run.energy += STEP_MS * (cluster.cluster_power +
+                                 busy * (cluster.active + cluster.core_power[index]))
+
+        demand = max(busy_frame, busy_background) * f / fmax
+        util += (demand - util) * decay
+        target = HEADROOM * util * fmax
+        want = next((i for i, freq in enumerate(freqs) if freq >= target), len(freqs) - 1)
+        if (want > index and t - last_change >= up_ms) or \
+                (want < index and t - last_change >= down_ms):
+            index = want
+            f = freqs[index]
+            last_change = t
+            run.changes += 1
+        t += STEP_MS
+
+    # Work still queued at the end never made it.
+    for i, _ in queue:
+        run.late += 1
+    return run
+
+
+def combine(frames, clusters, runs):
+    """Frame misses and completion times with one run per cluster."""
+    misses = 0
+    finishes = []
+    for i, (start, deadline, work) in enumerate(frames):
+        parts = [run.finish[i] for cluster, run in zip(clusters, runs) if cluster.name in work]
+        finish = None if None in parts else max(parts, default=start)
+        if finish is None or finish > start + deadline:
+            misses += 1
+        finishes.append(finish)
+    return misses, finishes
+
+
+def input_latency(frames, finishes, inputs):
+    latencies = []
+    i = 0
+    for ms in inputs:
+        while i < len(frames) and frames[i][0] < ms:
+            i += 1
+        if i < len(frames) and finishes[i] is not None:
+            latencies.append(finishes[i] - ms)
+    return sorted(latencies)
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    return values[min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    root = os.path.join(here, '..')
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--power-profile', default=os.path.join(
+        root, 'overlay', 'frameworks', 'base', 'core', 'res', 'res', 'xml', 'power_profile.xml'))
+    parser.add_argument('--init-rc', default=os.path.join(root, 'rootdir', 'etc', 'init.target.rc'))
+    parser.add_argument('--up', type=int, nargs='+', default=DEFAULT_UP, metavar='US')
+    parser.add_argument('--down', type=int, nargs='+', default=DEFAULT_DOWN, metavar='US')
+    parser.add_argument('--max-late', type=int, default=0, metavar='N',
+                        help='late frames a pick may add over the current setting')
+    parser.add_argument('--min-saving', type=float, default=0.5, metavar='MA',
+                        help='average mA a pick must save over the current setting')
+    parser.add_argument('--ftrace', action='store_true',
+                        help='TRACE is an ftrace capture with sched_switch events')
+    parser.add_argument('--deadline', type=float, default=16.0, metavar='MS',
+                        help='frame deadline for --ftrace')
+    parser.add_argument('--frame-comm', nargs='+', default=['RenderThread'], metavar='COMM',
+                        help='threads whose work is frame work for --ftrace')
+    parser.add_argument('trace')
+    args = parser.parse_args()
+
+    clusters = load_clusters(args.power_profile)
+    load_current(args.init_rc, clusters)
+    if args.ftrace:
+        frames, loads, inputs, end = import_ftrace(args.trace, clusters, args.deadline,
+                                                   set(args.frame_comm))
+    else:
+        frames, loads, inputs, end = load_trace(args.trace, {c.name for c in clusters})
+
+    current_runs = []
+    picked_runs = []
+    for cluster in clusters:
+        current = (cluster.up, cluster.down)
+        if None in current:
+            sys.exit('%s: no rate limits for cpu%d' % (args.init_rc, cluster.first_cpu))
+        pairs = sorted({current} | {(u, d) for u in args.up for d in args.down})
+        runs = {pair: simulate(cluster, frames, loads, end, *pair) for pair in pairs}
+        base = runs[current]
+        allowed = [r for r in runs.values() if r.late <= base.late + args.max_late and
+                   r.energy <= base.energy - args.min_saving * end]
+        pick = min(allowed, key=lambda r: (r.energy, r.late), default=base)
+        current_runs.append(base)
+        picked_runs.append(pick)
+
+        last = cluster.first_cpu + cluster.cores - 1
+        cpus = 'cpu%d' % last if cluster.cores == 1 else 'cpu%d-%d' % (cluster.first_cpu, last)
+        print('%s (%s)' % (cluster.name, cpus))
+        print('  %8s %8s %6s %8s %8s' % ('up us', 'down us', 'late', 'avg mA', 'changes'))
+        for pair, run in runs.items():
+            mark = ' current' if pair == current else ''
+            mark += ' picked' if run is pick else ''
+            print('  %8d %8d %6d %8.1f %8d%s' % (run.up, run.down, run.late, run.energy / end,
+                                                run.changes, mark))
+
+    print()
+    print('%-8s %8s %8s %14s %14s' % ('', 'misses', 'avg mA', 'input p50 ms', 'input p90 ms'))
+    for name, runs in (('current', current_runs), ('picked', picked_runs)):
+        misses, finishes = combine(frames, clusters, runs)
+        latency = input_latency(frames, finishes, inputs)
+        print('%-8s %8d %8.1f %14.1f %14.1f' % (name, misses, sum(r.energy for r in runs) / end,
+                                               percentile(latency, 50), percentile(latency, 90)))
+
+    print()
+    for cluster, run in zip(clusters, picked_runs):
+        base = '/sys/devices/system/cpu/cpu%d/cpufreq/schedutil' % cluster.first_cpu
+        print('    write %s/up_rate_limit_us %d' % (base, run.up))
+        print('    write %s/down_rate_limit_us %d' % (base, run.down))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,331 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Measure suspend/resume cycles from the kernel log and PM statistics.
+
+  suspendstat.py report CAPTURE...
+  suspendstat.py capture [-s SERIAL] [--clear] before|after CAPTURE
+
+A capture is a directory holding what was recorded around a standby
+period; only dmesg.txt is required:
+
+  dmesg.txt                      kernel log of the period
+  suspend_stats.{before,after}   /sys/kernel/debug/suspend_stats
+  wakeup_sources.{before,after}  /sys/kernel/debug/wakeup_sources
+  battery.{before,after}         charge_counter in uAh and the time
+  mem_sleep                      /sys/power/mem_sleep
+
+scripts/standby_deep is one, scripts/standby_deep.txt its report.
+
+report lists every suspend cycle in the log: the mode, how long suspend
+and resume took and the device phases of each, the time asleep when the
+kernel logs it and what woke the device or aborted the suspend. It then
+sums the capture up: resume latency percentiles per phase, wake reasons,
+the suspend_stats counters that moved, the wakeup sources that woke or
+held the device most and the standby drain. Several captures, one per
+mem_sleep mode (see persist.vendor.power.mem_sleep), are summed up side
+by side.
+
+Kernel timestamps stop while the device sleeps, so every duration is
+measured on one side of the sleep; the time asleep comes from the
+"Suspended for" message, which needs pm_debug_messages.
+
+capture records a capture from a device with adb root: "before" takes
+the statistics, with --clear also clearing the kernel log, and "after"
+takes them again along with the log. Unplug USB in between, the
+connection keeps the device awake.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+TIME = r'^\[\s*(\d+\.\d+)\]\s*'
+
+MARKERS = [
+    ('entry', re.compile(TIME + r'PM: suspend entry \((\w+)\)')),
+    ('exit', re.compile(TIME + r'PM: suspend exit')),
+    ('frozen', re.compile(TIME + r'Freezing remaining freezable tasks .*done')),
+    ('device', re.compile(TIME + r'PM: (suspend|late suspend|noirq suspend|noirq resume|'
+                          r'early resume|resume) of devices complete after ([\d.]+) msecs')),
+    ('sleep', re.compile(TIME + r'(?:Disabling non-boot CPUs|PM: suspend-to-idle)')),
+    ('wake', re.compile(TIME + r'(?:Enabling non-boot CPUs|PM: resume from suspend-to-idle)')),
+    ('reason', re.compile(TIME + r'(?:Resume caused by (.*)|Abort: (.*)|'
+                          r'PM: Device (\S+ failed to \w+.*)|PM: (Wakeup pending, aborting.*))')),
+    ('slept', re.compile(TIME + r'Suspended for ([\d.]+) seconds')),
+    ('thawed', re.compile(TIME + r'Restarting tasks \.\.\. done')),
+]
+
+SUSPEND_PHASES = ['suspend', 'late suspend', 'noirq suspend']
+RESUME_PHASES = ['noirq resume', 'early resume', 'resume']
+
+
+class Cycle:
+    def __init__(self, ms, mode):
+        self.entry = ms
+        self.mode = mode
+        self.last_suspend = None
+        self.sleep = None
+        self.wake = None
+        self.thawed = None
+        self.exit = None
+        self.phases = {}
+        self.reasons = []
+        self.slept = None
+        self.aborted = False
+
+    def suspend_ms(self):
+        end = self.sleep if self.sleep is not None else self.last_suspend
+        return end - self.entry if end is not None else None
+
+    def resume_ms(self):
+        end = self.thawed if self.thawed is not None else self.exit
+        return end - self.wake if self.wake is not None and end is not None else None
+
+
+def parse_dmesg(lines):
+    cycles = []
+    cycle = None
+    for line in lines:
+        for kind, regex in MARKERS:
+            match = regex.search(line)
+            if not match:
+                continue
+            ms = float(match.group(1)) * 1000
+            if kind == 'entry':
+                cycle = Cycle(ms, match.group(2))
+                cycles.append(cycle)
+            elif cycle is None:
+                pass
+            elif kind == 'exit':
+                cycle.exit = ms
+                cycle = None
+            elif kind == 'frozen':
+                cycle.last_suspend = ms
+            elif kind == 'device':
+                phase = match.group(2)
+                cycle.phases[phase] = float(match.group(3))
+                if phase in SUSPEND_PHASES:
+                    cycle.last_suspend = ms
+                elif cycle.wake is None:
+                    # The first resume message when nothing marked the wake.
+                    cycle.wake = ms - cycle.phases[phase]
+            elif kind == 'sleep':
+                cycle.sleep = ms
+            elif kind == 'wake':
+                if cycle.wake is None:
+                    cycle.wake = ms
+            elif kind == 'reason':
+                cycle.aborted |= match.group(2) is None
+                cycle.reasons.append(' '.join(g.strip() for g in match.groups()[1:] if g))
+            elif kind == 'slept':
+                cycle.slept = float(match.group(2))
+            elif kind == 'thawed':
+                cycle.thawed = ms
+            break
+    return cycles
+
+
+def parse_suspend_stats(path):
+    stats = {}
+    with open(path, 'r') as f:
+        for line in f:
+            key, sep, value = line.partition(':')
+            value = value.strip()
+            if sep and re.fullmatch(r'\d+', value):
+                stats[key.strip()] = int(value)
+    return stats
+
+
+def parse_wakeup_sources(path):
+    sources = {}
+    with open(path, 'r') as f:
+        lines = f.read().splitlines()
+    for line in lines[1:]:
+        fields = line.split()
+        if len(fields) < 10:
+            continue
+        name = ' '.join(fields[:-9])
+        numbers = [int(v) for v in fields[-9:]]
+        sources[name] = {'wakeup_count': numbers[2], 'total_time': numbers[5],
+                         'prevent_suspend_time': numbers[8]}
+    return sources
+
+
+def read_battery(path):
+    with open(path, 'r') as f:
+        uah, seconds = f.read().split()[:2]
+    return int(uah), int(seconds)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    if not values:
+        return None
+    return values[min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))]
+
+
+def fmt_ms(value):
+    return '%6.1f' % value if value is not None else '     -'
+
+
+class Capture:
+    def __init__(self, path):
+        self.path = path
+        self.name = os.path.basename(os.path.normpath(path))
+        with open(os.path.join(path, 'dmesg.txt'), 'r', errors='replace') as f:
+            self.cycles = parse_dmesg(f)
+        self.mode = None
+        mem_sleep = os.path.join(path, 'mem_sleep')
+        if os.path.exists(mem_sleep):
+            with open(mem_sleep, 'r') as f:
+                match = re.search(r'\[(\w+)\]', f.read())
+                self.mode = match.group(1) if match else None
+        self.stats = self.delta('suspend_stats', parse_suspend_stats)
+        self.sources = self.delta('wakeup_sources', parse_wakeup_sources)
+        self.drain = None
+        before, after = (os.path.join(path, 'battery.' + s) for s in ('before', 'after'))
+        if os.path.exists(before) and os.path.exists(after):
+            (uah0, t0), (uah1, t1) = read_battery(before), read_battery(after)
+            if t1 > t0:
+                self.drain = (uah0 - uah1) / 1000.0 / ((t1 - t0) / 3600.0)
+
+    def delta(self, name, parse):
+        before, after = (os.path.join(self.path, '%s.%s' % (name, s)) for s in ('before', 'after'))
+        if not (os.path.exists(before) and os.path.exists(after)):
+            return None
+        a, b = parse(before), parse(after)
+        if name == 'suspend_stats':
+            return {k: v - a.get(k, 0) for k, v in b.items() if v != a.get(k, 0)}
+        result = {}
+        for source, values in b.items():
+            old = a.get(source, {})
+            result[source] = {k: v - old.get(k, 0) for k, v in values.items()}
+        return result
+
+
+def print_cycles(capture):
+    print('%s:' % capture.path)
+    print('  %11s %-7s %8s %8s  %-28s %8s  %s' % ('entry', 'mode', 'suspend', 'resume',
+                                                  'noirq/early/devices ms', 'slept', 'reason'))
+    for c in capture.cycles:
+        phases = '/'.join(fmt_ms(c.phases.get(p)).strip() for p in RESUME_PHASES)
+        print('  %10.3fs %-7s %8s %8s  %-28s %8s  %s%s' % (
+            c.entry / 1000, c.mode, fmt_ms(c.suspend_ms()), fmt_ms(c.resume_ms()), phases,
+            '%.1fs' % c.slept if c.slept is not None else '-',
+            'ABORTED ' if c.aborted else '', '; '.join(c.reasons)))
+
+
+def summarize(capture):
+    """Returns the figures compared side by side and the lists of each."""
+    figures = []
+    lists = []
+    done = [c for c in capture.cycles if not c.aborted]
+    modes = sorted({c.mode for c in capture.cycles})
+    figures.append(('mem_sleep', capture.mode or ','.join(modes) or '-'))
+    figures.append(('cycles', '%d' % len(capture.cycles)))
+    figures.append(('aborted', '%d' % (len(capture.cycles) - len(done))))
+
+    def stat(label, values):
+        values = [v for v in values if v is not None]
+        for p in (50, 90):
+            figures.append(('%s p%d ms' % (label, p),
+                            '%.1f' % percentile(values, p) if values else '-'))
+        figures.append(('%s max ms' % label, '%.1f' % max(values) if values else '-'))
+
+    stat('suspend', [c.suspend_ms() for c in done])
+    stat('resume', [c.resume_ms() for c in done])
+    for phase in RESUME_PHASES:
+        values = [c.phases.get(phase) for c in done if phase in c.phases]
+        figures.append(('  %s p50' % phase, '%.1f' % percentile(values, 50) if values else '-'))
+    slept = [c.slept for c in done if c.slept is not None]
+    figures.append(('asleep s', '%.1f' % sum(slept) if slept else '-'))
+    figures.append(('drain mA', '%.1f' % capture.drain if capture.drain is not None else '-'))
+
+    reasons = {}
+    for c in capture.cycles:
+        for reason in c.reasons:
+            reasons[reason] = reasons.get(reason, 0) + 1
+    for reason, count in sorted(reasons.items(), key=lambda r: -r[1])[:5]:
+        lists.append(('reason', '%dx %s' % (count, reason)))
+    for key, value in sorted((capture.stats or {}).items()):
+        lists.append(('suspend_stats', '%s %+d' % (key, value)))
+    sources = (capture.sources or {}).items()
+    for name, values in sorted(sources, key=lambda s: -s[1]['wakeup_count'])[:5]:
+        if values['wakeup_count'] > 0:
+            lists.append(('woken by', '%dx %s' % (values['wakeup_count'], name)))
+    for name, values in sorted(sources, key=lambda s: -s[1]['prevent_suspend_time'])[:5]:
+        if values['prevent_suspend_time'] > 0:
+            lists.append(('held by', '%dms %s' % (values['prevent_suspend_time'], name)))
+    return figures, lists
+
+
+def report(paths):
+    captures = [Capture(path) for path in paths]
+    for capture in captures:
+        print_cycles(capture)
+        print()
+
+    summaries = [summarize(c) for c in captures]
+    width = max(12, max(len(c.name) for c in captures) + 2)
+    print('%-18s' % '' + ''.join('%*s' % (width, c.name) for c in captures))
+    for i, (label, _) in enumerate(summaries[0][0]):
+        print('%-18s' % label + ''.join('%*s' % (width, s[0][i][1]) for s in summaries))
+    for capture, (_, lists) in zip(captures, summaries):
+        if lists:
+            print('\n%s:' % capture.name)
+        for label, value in lists:
+            print('  %-14s %s' % (label, value))
+    return 0 if any(c.cycles for c in captures) else 1
+
+
+def adb(serial, command):
+    args = ['adb'] + (['-s', serial] if serial else []) + ['shell', command]
+    return subprocess.run(args, check=True, capture_output=True, text=True).stdout
+
+
+def capture(serial, when, path, clear):
+    os.makedirs(path, exist_ok=True)
+
+    def save(name, command):
+        with open(os.path.join(path, name), 'w') as f:
+            f.write(adb(serial, command))
+
+    save('suspend_stats.' + when, 'cat /sys/kernel/debug/suspend_stats')
+    save('wakeup_sources.' + when, 'cat /sys/kernel/debug/wakeup_sources')
+    save('battery.' + when, 'echo $(cat /sys/class/power_supply/battery/charge_counter) '
+                            '$(date +%s)')
+    if when == 'before':
+        save('mem_sleep', 'cat /sys/power/mem_sleep')
+        if clear:
+            adb(serial, 'dmesg -C')
+    else:
+        save('dmesg.txt', 'dmesg')
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    sub = parser.add_subparsers(dest='command', required=True)
+    command = sub.add_parser('report')
+    command.add_argument('captures', nargs='+')
+    command = sub.add_parser('capture')
+    command.add_argument('-s', '--serial')
+    command.add_argument('--clear', action='store_true', help='clear the kernel log before')
+    command.add_argument('when', choices=['before', 'after'])
+    command.add_argument('capture')
+    args = parser.parse_args()
+
+    if args.command == 'report':
+        return report(args.captures)
+    return capture(args.serial, args.when, args.capture, args.clear)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
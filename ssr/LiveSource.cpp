@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.ssrmon"
+
+#include "LiveSource.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <set>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/strings.h>
+#include <android-base/unique_fd.h>
+
+using android::base::ParseInt;
+using android::base::ReadFileToString;
+using android::base::Trim;
+using android::base::unique_fd;
+
+namespace vendor {
+namespace ssrmon {
+
+namespace {
+
+constexpr char kSubsysDir[] = "/sys/bus/msm_subsys/devices";
+constexpr char kRamdumps[] = "/sys/module/subsystem_restart/parameters/enable_ramdumps";
+const std::set<std::string> kTracked = {"adsp", "cdsp", "slpi", "modem", "npu"};
+
+struct Node {
+    std::string name;
+    std::string dir;
+    // The kernel sysfs_notify()s "state" on every transition.
+    unique_fd state;
+};
+
+int64_t NowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+std::string ReadAttr(const std::string& path) {
+    std::string value;
+    ReadFileToString(path, &value);
+    return Trim(value);
+}
+
+// Re-reading from the start also re-arms the poll.
+bool ReadState(int fd, std::string* state) {
+    char buf[32];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n < 0) return false;
+    *state = Trim(std::string(buf, n));
+    return true;
+}
+
+std::vector<Node> Discover() {
+    std::vector<Node> nodes;
+    std::unique_ptr<DIR, decltype(&closedir)> dir(opendir(kSubsysDir), closedir);
+    if (!dir) {
+        PLOG(ERROR) << "Failed to open " << kSubsysDir;
+        return nodes;
+    }
+    while (dirent* entry = readdir(dir.get())) {
+        if (entry->d_name[0] == '.') continue;
+        Node node;
+        node.dir = std::string(kSubsysDir) + "/" + entry->d_name;
+        node.name = ReadAttr(node.dir + "/name");
+        if (!kTracked.count(node.name)) continue;
+        node.state.reset(open((node.dir + "/state").c_str(), O_RDONLY | O_CLOEXEC));
+        if (node.state < 0) {
+            PLOG(ERROR) << "Failed to open " << node.dir << "/state";
+            continue;
+        }
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+}  // namespace
+
+bool RunLive(SsrMonitor& monitor, const std::function<void()>& onSsr) {
+    std::vector<Node> nodes = Discover();
+    if (nodes.empty()) return false;
+    for (const auto& node : nodes) LOG(INFO) << "Watching " << node.name << " at " << node.dir;
+
+    std::vector<pollfd> fds;
+    for (const auto& node : nodes) fds.push_back({node.state.get(), POLLPRI | POLLERR, 0});
+
+    while (true) {
+        size_t completed = monitor.history().size();
+        int64_t ms = NowMs();
+        for (const auto& node : nodes) {
+            std::string state;
+            if (!ReadState(node.state.get(), &state)) {
+                PLOG(ERROR) << "Failed to read " << node.name << " state";
+                return true;
+            }
+            monitor.onState(ms, node.name, state);
+            int count;
+            if (ParseInt(ReadAttr(node.dir + "/crash_count"), &count)) {
+                monitor.onCrashCount(ms, node.name, count);
+            }
+        }
+        monitor.onRamdumps(ms, ReadAttr(kRamdumps) == "1");
+        if (monitor.history().size() != completed) onSsr();
+
+        if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+            PLOG(ERROR) << "poll failed";
+            return true;
+        }
+    }
+}
+
+}  // namespace ssrmon
+}  // namespace vendor
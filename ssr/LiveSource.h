@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "SsrMonitor.h"
+
+namespace vendor {
+namespace ssrmon {
+
+// Feeds the monitor from /sys/bus/msm_subsys until a read fails,
+// calling onSsr after every completed restart. Returns false if none of
+// the tracked processors was found.
+bool RunLive(SsrMonitor& monitor, const std::function<void()>& onSsr);
+
+}  // namespace ssrmon
+}  // namespace vendor
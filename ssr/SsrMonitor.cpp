@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "SsrMonitor.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include <android-base/stringprintf.h>
+
+using android::base::StringPrintf;
+
+namespace vendor {
+namespace ssrmon {
+
+namespace {
+
+constexpr char kOnline[] = "ONLINE";
+constexpr char kOffline[] = "OFFLINE";
+constexpr char kOfflining[] = "OFFLINING";
+
+}  // namespace
+
+bool ParsePolicy(const std::string& name, Policy* policy) {
+    if (name == "keep") {
+        *policy = Policy::kKeep;
+    } else if (name == "fast_restart") {
+        *policy = Policy::kFastRestart;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* PolicyName(Policy policy) {
+    return policy == Policy::kFastRestart ? "fast_restart" : "keep";
+}
+
+SsrMonitor::SsrMonitor(Policy policy, RamdumpControl control)
+    : mPolicy(policy), mControl(std::move(control)) {}
+
+void SsrMonitor::onState(int64_t ms, const std::string& name, const std::string& state) {
+    Subsys& subsys = mSubsys[name];
+    if (subsys.state == state) return;
+    mEvents.push_back(StringPrintf("%" PRId64 " state %s %s", ms, name.c_str(), state.c_str()));
+
+    // The first state read is where we attach, not a transition.
+    bool attached = !subsys.state.empty();
+    subsys.state = state;
+    if (!attached) return;
+
+    if (state == kOfflining && subsys.ssr.crash < 0) {
+        subsys.ssr = Ssr{name, ms, -1, -1, mRamdumps};
+    } else if (state == kOffline && subsys.ssr.crash >= 0) {
+        subsys.ssr.offline = ms;
+    } else if (state == kOnline && subsys.ssr.crash >= 0) {
+        finish(ms, subsys);
+    }
+}
+
+void SsrMonitor::onCrashCount(int64_t ms, const std::string& name, int count) {
+    Subsys& subsys = mSubsys[name];
+    if (subsys.crashCount == count) return;
+    mEvents.push_back(StringPrintf("%" PRId64 " crash_count %s %d", ms, name.c_str(), count));
+
+    bool crashed = subsys.crashCount >= 0 && count > subsys.crashCount;
+    subsys.crashCount = count;
+    if (!crashed || subsys.ssr.crash >= 0) return;
+    subsys.ssr = Ssr{name, ms, -1, -1, mRamdumps};
+    // Sources read the state before the counter, and only after a state
+    // notification. A crash counted while the processor reads ONLINE
+    // went OFFLINING and back between two reads, so it is already over.
+    if (subsys.state == kOnline) finish(ms, subsys);
+}
+
+void SsrMonitor::onRamdumps(int64_t ms, bool enabled) {
+    if (mRamdumpsKnown && mRamdumps == enabled) return;
+    mEvents.push_back(StringPrintf("%" PRId64 " ramdumps %d", ms, enabled));
+    mRamdumps = enabled;
+    mRamdumpsKnown = true;
+}
+
+void SsrMonitor::finish(int64_t ms, Subsys& subsys) {
+    subsys.ssr.online = ms;
+    mHistory.push_back(subsys.ssr);
+    const Ssr& ssr = mHistory.back();
+    subsys.ssr = Ssr{};
+
+    // The dump is taken before the processor boots again, so once it
+    // is online the first dump of this boot is safe.
+    if (mPolicy == Policy::kFastRestart && ssr.ramdump && mRamdumps) {
+        mEvents.push_back(StringPrintf("%" PRId64 " set ramdumps 0", ms));
+        mRamdumps = false;
+        if (mControl) mControl(ms, false);
+    }
+}
+
+void SsrMonitor::writeReport(std::ostream& out) const {
+    out << "# ssrmon 1 policy " << PolicyName(mPolicy) << "\n";
+
+    std::map<std::string, std::vector<int64_t>> recovery;
+    for (const auto& ssr : mHistory) recovery[ssr.subsys].push_back(ssr.online - ssr.crash);
+    for (auto& [name, times] : recovery) {
+        std::sort(times.begin(), times.end());
+        out << StringPrintf("# subsys %s ssrs %zu recovery min %" PRId64 " median %" PRId64
+                            " max %" PRId64 "\n",
+                            name.c_str(), times.size(), times.front(), times[times.size() / 2],
+                            times.back());
+    }
+    for (const auto& ssr : mHistory) {
+        out << StringPrintf("# ssr %s crash %" PRId64 " offline %" PRId64 " online %" PRId64
+                            " recovery %" PRId64 " ramdump %d\n",
+                            ssr.subsys.c_str(), ssr.crash, ssr.offline, ssr.online,
+                            ssr.online - ssr.crash, ssr.ramdump);
+    }
+    for (const auto& event : mEvents) out << event << "\n";
+}
+
+}  // namespace ssrmon
+}  // namespace vendor
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vendor {
+namespace ssrmon {
+
+enum class Policy {
+    // Leave enable_ramdumps alone.
+    kKeep,
+    // Collect the first ramdump of a boot, then restart without dumps.
+    kFastRestart,
+};
+
+bool ParsePolicy(const std::string& name, Policy* policy);
+const char* PolicyName(Policy policy);
+
+// One subsystem restart. Times are ms since boot, -1 if not seen.
+struct Ssr {
+    std::string subsys;
+    int64_t crash = -1;
+    int64_t offline = -1;
+    int64_t online = -1;
+    bool ramdump = false;
+};
+
+// Follows the msm_subsys state ("OFFLINING", "OFFLINE", "ONLINE") and
+// crash_count of each remote processor and times every crash until the
+// processor is back online. State sources (sysfs or a script) feed it
+// timestamped events; it never reads the clock or sysfs itself.
+class SsrMonitor {
+  public:
+    // Called to change enable_ramdumps for the rest of the boot.
+    using RamdumpControl = std::function<void(int64_t ms, bool enable)>;
+
+    SsrMonitor(Policy policy, RamdumpControl control);
+
+    void onState(int64_t ms, const std::string& subsys, const std::string& state);
+    void onCrashCount(int64_t ms, const std::string& subsys, int count);
+    void onRamdumps(int64_t ms, bool enabled);
+
+    const std::vector<Ssr>& history() const { return mHistory; }
+
+    // Per-subsystem summary and completed SSRs as comment lines,
+    // followed by the event trace in the format the script source reads.
+    void writeReport(std::ostream& out) const;
+
+  private:
+    struct Subsys {
+        std::string state;
+        int crashCount = -1;
+        // In progress, crash < 0 if the processor is up.
+        Ssr ssr;
+    };
+
+    void finish(int64_t ms, Subsys& subsys);
+
+    Policy mPolicy;
+    RamdumpControl mControl;
+    bool mRamdumps = false;
+    bool mRamdumpsKnown = false;
+    std::map<std::string, Subsys> mSubsys;
+    std::vector<Ssr> mHistory;
+    std::vector<std::string> mEvents;
+};
+
+}  // namespace ssrmon
+}  // namespace vendor
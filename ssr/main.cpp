@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.ssrmon"
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#ifdef __ANDROID__
+#include <android-base/properties.h>
+#endif
+
+#include "SsrMonitor.h"
+#ifdef __ANDROID__
+#include "LiveSource.h"
+#endif
+
+using android::base::ParseInt;
+using android::base::WriteStringToFile;
+using vendor::ssrmon::ParsePolicy;
+using vendor::ssrmon::Policy;
+using vendor::ssrmon::PolicyName;
+using vendor::ssrmon::SsrMonitor;
+
+namespace {
+
+#ifdef __ANDROID__
+constexpr char kDefaultOut[] = "/data/vendor/ssrmon";
+constexpr char kFastRestartProp[] = "persist.vendor.ssr.fast_restart";
+// init writes it to enable_ramdumps, see vendor.ssrmon.rc.
+constexpr char kRamdumpsProp[] = "vendor.ssrmon.ramdumps";
+#endif
+
+// Replays a script of the events the sysfs source produces:
+//   <ms> state <subsys> <OFFLINING|OFFLINE|ONLINE>
+//   <ms> crash_count <subsys> <n>
+//   <ms> ramdumps <0|1>
+// "set" lines, the monitor's own actions in a report, are skipped so a
+// report can be replayed under another policy.
+bool Replay(std::istream& in, SsrMonitor& monitor) {
+    std::string line;
+    int lineno = 0;
+    while (std::getline(in, line)) {
+        lineno++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string time, kind, name, value;
+        if (!(fields >> time)) continue;
+        int64_t ms;
+        if (!ParseInt(time, &ms) || !(fields >> kind >> name)) {
+            LOG(ERROR) << "script line " << lineno << ": malformed event";
+            return false;
+        }
+        int count;
+        if (kind == "state" && fields >> value) {
+            monitor.onState(ms, name, value);
+        } else if (kind == "crash_count" && fields >> value && ParseInt(value, &count)) {
+            monitor.onCrashCount(ms, name, count);
+        } else if (kind == "ramdumps" && (name == "0" || name == "1")) {
+            monitor.onRamdumps(ms, name == "1");
+        } else if (kind != "set") {
+            LOG(ERROR) << "script line " << lineno << ": unknown event " << kind;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WriteReport(const SsrMonitor& monitor, const std::string& dir) {
+    std::ostringstream report;
+    monitor.writeReport(report);
+    std::string tmp = dir + "/ssr.txt.tmp";
+    if (!WriteStringToFile(report.str(), tmp) || rename(tmp.c_str(), (dir + "/ssr.txt").c_str())) {
+        PLOG(ERROR) << "Failed to write report to " << dir;
+        return false;
+    }
+    return true;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--policy keep|fast_restart] [--out DIR] [--script FILE]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string policyName;
+    std::string out;
+    std::string script;
+
+    static const option options[] = {
+            {"policy", required_argument, nullptr, 'p'},
+            {"out", required_argument, nullptr, 'o'},
+            {"script", required_argument, nullptr, 's'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:o:s:", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p': policyName = optarg; break;
+            case 'o': out = optarg; break;
+            case 's': script = optarg; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    Policy policy = Policy::kKeep;
+    if (!policyName.empty() && !ParsePolicy(policyName, &policy)) {
+        Usage(argv[0]);
+        return 1;
+    }
+#ifdef __ANDROID__
+    if (policyName.empty() && android::base::GetBoolProperty(kFastRestartProp, false)) {
+        policy = Policy::kFastRestart;
+    }
+#endif
+
+    if (!script.empty()) {
+        SsrMonitor monitor(policy, nullptr);
+        std::ifstream in(script);
+        if (!in) {
+            PLOG(ERROR) << "Failed to open " << script;
+            return 1;
+        }
+        if (!Replay(in, monitor)) return 1;
+        if (out.empty()) {
+            monitor.writeReport(std::cout);
+            return 0;
+        }
+        return WriteReport(monitor, out) ? 0 : 1;
+    }
+
+#ifdef __ANDROID__
+    if (out.empty()) out = kDefaultOut;
+    LOG(INFO) << "Policy " << PolicyName(policy);
+    SsrMonitor monitor(policy, [](int64_t, bool enable) {
+        LOG(INFO) << (enable ? "Enabling" : "Disabling") << " ramdumps";
+        android::base::SetProperty(kRamdumpsProp, enable ? "1" : "0");
+    });
+    bool found = RunLive(monitor, [&] {
+        const auto& ssr = monitor.history().back();
+        LOG(WARNING) << ssr.subsys << " restarted in " << ssr.online - ssr.crash << " ms"
+                     << (ssr.ramdump ? " with ramdump" : "");
+        WriteReport(monitor, out);
+    });
+    if (!found) {
+        LOG(ERROR) << "No remote processors found";
+        return 1;
+    }
+    return 0;
+#else
+    Usage(argv[0]);
+    return 1;
+#endif
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <DisplayConfig.h>
+#include <FodHbm.h>
+#include <FodUi.h>
+#include <libinit_utils.h>
+#include <libinit_variant.h>
+
+#include "fakes/FakeProperties.h"
+#include "fakes/FakeSdmDisplay.h"
+
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodHbmScheduler;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodUiWatcher;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::VsyncSource;
+using fakes::FakeSdmDisplay;
+using vendor::lineage::livedisplay::V2_1::implementation::DisplayConfig;
+using vendor::lineage::livedisplay::V2_1::implementation::ModeInfo;
+using vendor::lineage::livedisplay::V2_1::implementation::PaValues;
+
+namespace {
+
+class SteadyVsyncSource : public VsyncSource {
+  public:
+    bool lastVsync(int64_t nowNs, int64_t* vsyncNs) override {
+        *vsyncNs = nowNs - nowNs % 16666667;
+        return true;
+    }
+};
+
+// A finger held on the sensor: the panel keeps notifying the state HBM
+// is already in.
+void BM_FodUiHeldNotify(benchmark::State& state) {
+    uint64_t switches = 0;
+    FodUiWatcher watcher([&](bool, int64_t) { switches++; });
+    int64_t now = 0;
+    for (auto _ : state) watcher.onNotify(true, now++);
+    benchmark::DoNotOptimize(switches);
+}
+BENCHMARK(BM_FodUiHeldNotify);
+
+void BM_FodHbmSwitchTime(benchmark::State& state) {
+    SteadyVsyncSource vsync;
+    FodHbmScheduler scheduler(vsync);
+    int64_t now = 1000000000;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(scheduler.switchTime(now));
+        now += 1234567;
+    }
+}
+BENCHMARK(BM_FodHbmSwitchTime);
+
+// What every LiveDisplay settings query costs once the state is cached.
+void BM_DisplayConfigActiveMode(benchmark::State& state) {
+    FakeSdmDisplay display;
+    DisplayConfig config(display);
+    ModeInfo mode;
+    for (auto _ : state) benchmark::DoNotOptimize(config.activeMode(&mode));
+}
+BENCHMARK(BM_DisplayConfigActiveMode);
+
+void BM_DisplayConfigApplyPa(benchmark::State& state) {
+    FakeSdmDisplay display;
+    DisplayConfig config(display);
+    PaValues pa[] = {{10, 0, 0, 0, 0}, {20, 0, 0, 0, 0}};
+    int i = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(config.apply({std::nullopt, false, pa[i ^= 1]}));
+}
+BENCHMARK(BM_DisplayConfigApplyPa);
+
+// The part of vendor_load_properties on the boot critical path.
+void BM_SetVariantProps(benchmark::State& state) {
+    const variant_info_t variant = {
+            .hwc_value = "",
+            .sku_value = "",
+            .brand = "Xiaomi",
+            .device = "raphael",
+            .marketname = "Redmi K20 Pro",
+            .model = "M1903F11A",
+            .build_fingerprint = "Xiaomi/raphael/raphael:11/RKQ1.200826.002/"
+                                 "V12.5.6.0.RFKCNXM:user/release-keys",
+            .nfc = true,
+    };
+    fakes::ClearProperties();
+    for (auto _ : state) set_variant_props(variant);
+}
+BENCHMARK(BM_SetVariantProps);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <DisplayConfig.h>
+
+#include "fakes/FakeSdmDisplay.h"
+
+using fakes::FakeSdmDisplay;
+using vendor::lineage::livedisplay::V2_1::implementation::DisplayConfig;
+using vendor::lineage::livedisplay::V2_1::implementation::ModeInfo;
+using vendor::lineage::livedisplay::V2_1::implementation::PaValues;
+
+namespace {
+
+class DisplayConfigTest : public testing::Test {
+  protected:
+    FakeSdmDisplay display;
+    DisplayConfig config{display};
+};
+
+}  // namespace
+
+TEST_F(DisplayConfigTest, QueriesTheDaemonOnce) {
+    ModeInfo mode;
+    for (int i = 0; i < 3; i++) {
+        std::vector<ModeInfo> modes;
+        ASSERT_TRUE(config.modes(&modes));
+        ASSERT_TRUE(config.activeMode(&mode));
+    }
+    EXPECT_EQ("Standard", mode.name);
+    EXPECT_EQ(1, display.calls["get_modes"]);
+    EXPECT_EQ(1, display.calls["get_active_mode"]);
+}
+
+TEST_F(DisplayConfigTest, SwitchesModeAndMakesItDefault) {
+    ASSERT_TRUE(config.apply({1, true, std::nullopt}));
+    EXPECT_EQ(1, display.active);
+    EXPECT_EQ(1, display.defaultId);
+
+    ModeInfo mode;
+    ASSERT_TRUE(config.defaultMode(&mode));
+    EXPECT_EQ("Vivid", mode.name);
+    EXPECT_EQ(2u, config.sets());
+}
+
+TEST_F(DisplayConfigTest, SkipsWhatIsAlreadySet) {
+    PaValues pa;
+    ASSERT_TRUE(config.pa(&pa));
+    ASSERT_TRUE(config.apply({0, true, pa}));
+    EXPECT_EQ(0u, config.sets());
+}
+
+TEST_F(DisplayConfigTest, RejectsUnknownModesAndPaOutOfRange) {
+    EXPECT_FALSE(config.apply({7, false, std::nullopt}));
+    EXPECT_FALSE(config.apply({1, false, PaValues{0, 2, 0, 0, 0}}));
+    EXPECT_EQ(0u, config.sets());
+    EXPECT_EQ(0, display.active);
+}
+
+TEST_F(DisplayConfigTest, RevertsTheModeWhenPaFails) {
+    display.failing.insert("set_pa");
+    EXPECT_FALSE(config.apply({1, true, PaValues{10, 0, 0, 0, 0}}));
+    EXPECT_EQ(0, display.active);
+    EXPECT_EQ(0, display.defaultId);
+
+    ModeInfo mode;
+    ASSERT_TRUE(config.activeMode(&mode));
+    EXPECT_EQ("Standard", mode.name);
+}
+
+TEST_F(DisplayConfigTest, ReadsTheModePaAfterASwitch) {
+    ASSERT_TRUE(config.apply({1, false, std::nullopt}));
+    PaValues pa;
+    ASSERT_TRUE(config.pa(&pa));
+    EXPECT_EQ(display.modePa[1], pa);
+}
+
+TEST_F(DisplayConfigTest, RevertsTheModeWhenPaCannotBeRead) {
+    display.failing.insert("get_pa");
+    EXPECT_FALSE(config.apply({1, true, PaValues{10, 0, 0, 0, 0}}));
+    EXPECT_EQ(0, display.active);
+    EXPECT_EQ(0, display.defaultId);
+}
+
+TEST_F(DisplayConfigTest, DefaultPaFollowsTheMode) {
+    PaValues pa;
+    ASSERT_TRUE(config.defaultPa(&pa));
+    EXPECT_EQ(display.modePa[0], pa);
+
+    // What the user set is not what a reset goes back to.
+    ASSERT_TRUE(config.apply({1, false, PaValues{10, 0, 0, 0, 0}}));
+    ASSERT_TRUE(config.defaultPa(&pa));
+    EXPECT_EQ(display.modePa[1], pa);
+
+    ASSERT_TRUE(config.apply({2, false, std::nullopt}));
+    ASSERT_TRUE(config.defaultPa(&pa));
+    EXPECT_EQ(display.modePa[2], pa);
+}
+
+TEST_F(DisplayConfigTest, NoPaWithoutSupport) {
+    display.failing.insert("has_pa");
+    PaValues pa;
+    EXPECT_FALSE(config.hasPa());
+    EXPECT_FALSE(config.pa(&pa));
+    EXPECT_FALSE(config.apply({std::nullopt, false, pa}));
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <FodHbm.h>
+#include <FodUi.h>
+
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodHbmScheduler;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodUiSource;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::FodUiWatcher;
+using android::hardware::biometrics::fingerprint::V2_3::implementation::VsyncSource;
+
+namespace {
+
+constexpr int64_t kMs = 1000000;
+constexpr int64_t kPeriod = 16666667;
+
+// fod_ui as the panel driver notifies it, from a list.
+class ListFodUiSource : public FodUiSource {
+  public:
+    explicit ListFodUiSource(std::vector<std::pair<int64_t, bool>> notifications)
+        : mNotifications(std::move(notifications)) {}
+
+    bool wait(bool* pressed, int64_t* timeNs) override {
+        if (mNext == mNotifications.size()) return false;
+        *timeNs = mNotifications[mNext].first;
+        *pressed = mNotifications[mNext].second;
+        mNext++;
+        return true;
+    }
+
+  private:
+    std::vector<std::pair<int64_t, bool>> mNotifications;
+    size_t mNext = 0;
+};
+
+// The crtc's vsync_event, at a fixed period from phase on.
+class FakeVsyncSource : public VsyncSource {
+  public:
+    bool on = true;
+    int64_t phase = 0;
+
+    bool lastVsync(int64_t nowNs, int64_t* vsyncNs) override {
+        if (!on || nowNs < phase) return false;
+        *vsyncNs = nowNs - (nowNs - phase) % kPeriod;
+        return true;
+    }
+};
+
+}  // namespace
+
+TEST(FodUiWatcherTest, SwitchesOnlyOnChanges) {
+    std::vector<std::pair<bool, int64_t>> switches;
+    FodUiWatcher watcher([&](bool pressed, int64_t timeNs) {
+        switches.emplace_back(pressed, timeNs);
+    });
+    // The panel notifies on every touch report while the finger is down.
+    ListFodUiSource source({{1, true}, {2, true}, {3, true}, {4, false}, {5, false}, {6, true}});
+    watcher.run(source);
+
+    EXPECT_EQ(6u, watcher.notifications());
+    EXPECT_EQ(3u, watcher.switches());
+    std::vector<std::pair<bool, int64_t>> expected = {{true, 1}, {false, 4}, {true, 6}};
+    EXPECT_EQ(expected, switches);
+}
+
+TEST(FodUiWatcherTest, FirstNotificationAlwaysSwitches) {
+    int switches = 0;
+    FodUiWatcher watcher([&](bool, int64_t) { switches++; });
+    // The HAL starts with HBM in an unknown state.
+    watcher.onNotify(false, 0);
+    EXPECT_EQ(1, switches);
+    watcher.onNotify(false, 1);
+    EXPECT_EQ(1, switches);
+}
+
+TEST(FodHbmSchedulerTest, SwitchesRightAwayEarlyInAFrame) {
+    FakeVsyncSource vsync;
+    FodHbmScheduler scheduler(vsync);
+    int64_t now = 10 * kPeriod + 1 * kMs;
+    EXPECT_EQ(now, scheduler.switchTime(now));
+}
+
+TEST(FodHbmSchedulerTest, WaitsForTheNextFrameLateInAFrame) {
+    FakeVsyncSource vsync;
+    FodHbmScheduler::Params params;
+    FodHbmScheduler scheduler(vsync, params);
+    int64_t now = 10 * kPeriod + 8 * kMs;
+    EXPECT_EQ(11 * kPeriod + params.guardNs, scheduler.switchTime(now));
+}
+
+TEST(FodHbmSchedulerTest, SwitchesRightAwayWithoutVsync) {
+    FakeVsyncSource vsync;
+    vsync.on = false;
+    FodHbmScheduler scheduler(vsync);
+    EXPECT_EQ(8 * kMs, scheduler.switchTime(8 * kMs));
+}
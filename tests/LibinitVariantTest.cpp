@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <libinit_utils.h>
+#include <libinit_variant.h>
+
+#include "fakes/FakeProperties.h"
+
+namespace {
+
+const variant_info_t kIndia = {
+        .hwc_value = "INDIA",
+        .sku_value = "",
+        .brand = "Xiaomi",
+        .device = "raphaelin",
+        .marketname = "Redmi K20 Pro",
+        .model = "MZB7751IN",
+        .build_fingerprint = "Xiaomi/raphaelin/raphaelin:11/RKQ1.200826.002/"
+                             "V12.5.1.0.RFKINXM:user/release-keys",
+        .nfc = false,
+};
+
+const variant_info_t kChina = {
+        .hwc_value = "",
+        .sku_value = "",
+        .brand = "Xiaomi",
+        .device = "raphael",
+        .marketname = "Redmi K20 Pro",
+        .model = "M1903F11A",
+        .build_fingerprint = "Xiaomi/raphael/raphael:11/RKQ1.200826.002/"
+                             "V12.5.6.0.RFKCNXM:user/release-keys",
+        .nfc = true,
+};
+
+const std::vector<variant_info_t> kVariants = {kIndia, kChina};
+
+class LibinitVariantTest : public testing::Test {
+  protected:
+    void SetUp() override { fakes::ClearProperties(); }
+};
+
+}  // namespace
+
+TEST_F(LibinitVariantTest, FindsTheFirstMatchingVariant) {
+    EXPECT_EQ(&kVariants[0], find_variant(kVariants, "INDIA", ""));
+    // An empty hwc_value matches anything, so the last entry is the
+    // fallback.
+    EXPECT_EQ(&kVariants[1], find_variant(kVariants, "CN", ""));
+    EXPECT_EQ(&kVariants[1], find_variant(kVariants, "", "nfc"));
+    EXPECT_EQ(nullptr, find_variant({kIndia}, "GLOBAL", ""));
+}
+
+TEST_F(LibinitVariantTest, DescribesTheFingerprint) {
+    EXPECT_EQ("raphael-user 11 RKQ1.200826.002 V12.5.6.0.RFKCNXM release-keys",
+              fingerprint_to_description(kChina.build_fingerprint));
+}
+
+TEST_F(LibinitVariantTest, OverridesEveryPartitionsBuildProps) {
+    fakes::SetProperty("ro.product.vendor.model", "generic");
+    set_variant_props(kChina);
+
+    for (const char* partition : {"", "odm.", "vendor.", "system.", "system_ext.", "bootimage."}) {
+        std::string prefix = std::string("ro.product.") + partition;
+        EXPECT_EQ("M1903F11A", fakes::GetProperty(prefix + "model", "")) << prefix;
+        EXPECT_EQ("raphael", fakes::GetProperty(prefix + "name", "")) << prefix;
+    }
+    EXPECT_EQ(kChina.build_fingerprint, fakes::GetProperty("ro.build.fingerprint", ""));
+    EXPECT_EQ(kChina.build_fingerprint, fakes::GetProperty("ro.vendor.build.fingerprint", ""));
+    EXPECT_EQ("M1903F11A", fakes::GetProperty("ro.build.product", ""));
+    EXPECT_EQ("android-xiaomi", fakes::GetProperty("ro.com.google.clientidbase", ""));
+}
+
+TEST_F(LibinitVariantTest, SetsTheNfcSkuOnlyForNfcVariants) {
+    set_variant_props(kIndia);
+    EXPECT_EQ("", fakes::GetProperty("ro.boot.product.hardware.sku", ""));
+
+    fakes::ClearProperties();
+    set_variant_props(kChina);
+    EXPECT_EQ("nfc", fakes::GetProperty("ro.boot.product.hardware.sku", ""));
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cmath>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <UdfpsDim.h>
+#include <UdfpsDimTable.h>
+
+namespace {
+
+// The alpha that lets through the light of a level at nits, see udfps_dim.py.
+double exactAlpha(double nits) {
+    return (1 - std::pow(nits / kUdfpsHbmNits, 1 / 2.2)) * 255;
+}
+
+TEST(UdfpsDimTest, AlphaNeverRisesWithTheBacklight) {
+    for (uint32_t level = 1; level < 256; level++) {
+        EXPECT_LE(getUdfpsDimAlpha(level), getUdfpsDimAlpha(level - 1)) << "backlight " << level;
+    }
+}
+
+TEST(UdfpsDimTest, LevelsPastTheTableClamp) {
+    EXPECT_EQ(getUdfpsDimAlpha(256), getUdfpsDimAlpha(255));
+    EXPECT_EQ(getUdfpsDimAlpha(UINT32_MAX), getUdfpsDimAlpha(255));
+}
+
+// Below the first measured level the curve runs straight down to black.
+TEST(UdfpsDimTest, BacklightOffIsFullyDimmed) {
+    EXPECT_EQ(getUdfpsDimAlpha(0), 255);
+}
+
+// Levels and nits from config_screenBrightnessBacklight and
+// config_screenBrightnessNits.
+TEST(UdfpsDimTest, FollowsTheBrightnessCurve) {
+    const struct {
+        uint32_t level;
+        double nits;
+    } kCurve[] = {{1, 2.2}, {85, 140}, {170, 280}, {255, 420}};
+    for (const auto& [level, nits] : kCurve) {
+        EXPECT_NEAR(getUdfpsDimAlpha(level), exactAlpha(nits), 0.5) << "backlight " << level;
+    }
+}
+
+// HBM is brighter than any normal level, so even full brightness is dimmed.
+TEST(UdfpsDimTest, FullBrightnessIsDimmedBelowHbm) {
+    EXPECT_GT(kUdfpsHbmNits, 420);
+    EXPECT_GT(getUdfpsDimAlpha(255), 0);
+}
+
+}  // namespace
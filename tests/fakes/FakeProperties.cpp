@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "FakeProperties.h"
+
+#include <map>
+#include <memory>
+
+#include <sys/_system_properties.h>
+
+struct prop_info {
+    std::string value;
+};
+
+namespace {
+
+std::map<std::string, std::unique_ptr<prop_info>>& Properties() {
+    static auto* properties = new std::map<std::string, std::unique_ptr<prop_info>>;
+    return *properties;
+}
+
+}  // namespace
+
+const prop_info* __system_property_find(const char* name) {
+    auto it = Properties().find(name);
+    return it == Properties().end() ? nullptr : it->second.get();
+}
+
+int __system_property_update(prop_info* pi, const char* value, unsigned int len) {
+    pi->value.assign(value, len);
+    return 0;
+}
+
+int __system_property_add(const char* name, unsigned int namelen, const char* value,
+                          unsigned int valuelen) {
+    auto& pi = Properties()[std::string(name, namelen)];
+    if (pi) return -1;
+    pi.reset(new prop_info{std::string(value, valuelen)});
+    return 0;
+}
+
+namespace fakes {
+
+void ClearProperties() {
+    Properties().clear();
+}
+
+void SetProperty(const std::string& name, const std::string& value) {
+    auto& pi = Properties()[name];
+    if (!pi) pi.reset(new prop_info);
+    pi->value = value;
+}
+
+std::string GetProperty(const std::string& name, const std::string& defaultValue) {
+    const prop_info* pi = __system_property_find(name.c_str());
+    return pi ? pi->value : defaultValue;
+}
+
+size_t PropertyCount() {
+    return Properties().size();
+}
+
+}  // namespace fakes
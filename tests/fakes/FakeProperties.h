@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace fakes {
+
+// The property area libinit_utils writes to on the host, see
+// init/host/sys/_system_properties.h. Unlike the real one it lets tests
+// start over and read back what was written.
+void ClearProperties();
+void SetProperty(const std::string& name, const std::string& value);
+std::string GetProperty(const std::string& name, const std::string& defaultValue);
+size_t PropertyCount();
+
+}  // namespace fakes
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <SdmDisplay.h>
+
+namespace fakes {
+
+using vendor::lineage::livedisplay::V2_1::implementation::ModeInfo;
+using vendor::lineage::livedisplay::V2_1::implementation::PaRanges;
+using vendor::lineage::livedisplay::V2_1::implementation::PaValues;
+using vendor::lineage::livedisplay::V2_1::implementation::SdmDisplay;
+
+// Stands in for the display daemon behind binder: counts every call,
+// fails the ones in failing, and switching modes loads the mode's PA.
+class FakeSdmDisplay : public SdmDisplay {
+  public:
+    FakeSdmDisplay() {
+        modes = {{0, "Standard"}, {1, "Vivid"}, {2, "sRGB"}};
+        modePa = {{0, 0, 0, 0, 0}, {0, 0.2f, 0, 0.1f, 0}, {0, -0.1f, 0, 0, 0}};
+        pa = modePa[0];
+    }
+
+    std::vector<ModeInfo> modes;
+    std::vector<PaValues> modePa;
+    int32_t active = 0;
+    int32_t defaultId = 0;
+    PaValues pa;
+    std::set<std::string> failing;
+    std::map<std::string, int> calls;
+
+    bool getModes(std::vector<ModeInfo>* out) override {
+        *out = modes;
+        return call("get_modes");
+    }
+    bool getActiveMode(int32_t* id) override {
+        *id = active;
+        return call("get_active_mode");
+    }
+    bool getDefaultMode(int32_t* id) override {
+        *id = defaultId;
+        return call("get_default_mode");
+    }
+    bool setActiveMode(int32_t id) override {
+        if (!call("set_active_mode")) return false;
+        active = id;
+        for (size_t i = 0; i < modes.size(); i++) {
+            if (modes[i].id == id) pa = modePa[i];
+        }
+        return true;
+    }
+    bool setDefaultMode(int32_t id) override {
+        if (!call("set_default_mode")) return false;
+        defaultId = id;
+        return true;
+    }
+    bool hasPa() override { return call("has_pa"); }
+    bool getPaRanges(PaRanges* ranges) override {
+        *ranges = {{-180, 180, 1}, {-1, 1, 0.01f}, {-1, 1, 0.01f}, {-1, 1, 0.01f}, {0, 1, 0.01f}};
+        return call("get_pa_ranges");
+    }
+    bool getPa(PaValues* out) override {
+        *out = pa;
+        return call("get_pa");
+    }
+    bool setPa(const PaValues& values) override {
+        if (!call("set_pa")) return false;
+        pa = values;
+        return true;
+    }
+
+  private:
+    bool call(const std::string& name) {
+        calls[name]++;
+        return !failing.count(name);
+    }
+};
+
+}  // namespace fakes
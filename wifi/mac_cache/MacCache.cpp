@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MacCache.h"
+
+#include <algorithm>
+
+#include <android-base/parseint.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <zlib.h>
+
+using android::base::EndsWith;
+using android::base::ParseUint;
+using android::base::Split;
+using android::base::StartsWith;
+using android::base::StringPrintf;
+using android::base::Trim;
+
+namespace vendor {
+namespace wlanmac {
+
+namespace {
+
+constexpr char kIntfPrefix[] = "Intf";
+constexpr char kIntfSuffix[] = "MacAddress";
+constexpr char kEnd[] = "END";
+constexpr char kCacheMagic[] = "wlan_mac_cache";
+constexpr unsigned int kCacheVersion = 1;
+
+// "Intf<n>MacAddress"
+bool ParseKey(const std::string& key, unsigned int* index) {
+    constexpr size_t kAffixes = sizeof(kIntfPrefix) - 1 + sizeof(kIntfSuffix) - 1;
+    if (key.size() <= kAffixes || !StartsWith(key, kIntfPrefix) || !EndsWith(key, kIntfSuffix)) {
+        return false;
+    }
+    return ParseUint(key.substr(sizeof(kIntfPrefix) - 1, key.size() - kAffixes), index);
+}
+
+bool ParseMac(const std::string& hex, MacAddress* mac) {
+    if (hex.size() != 2 * mac->size()) return false;
+    for (size_t i = 0; i < mac->size(); i++) {
+        unsigned int byte;
+        if (!ParseUint("0x" + hex.substr(2 * i, 2), &byte)) return false;
+        (*mac)[i] = byte;
+    }
+    return true;
+}
+
+uint32_t Crc32(const std::string& data) {
+    return crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data.data()), data.size());
+}
+
+}  // namespace
+
+bool ParseMacFile(const std::string& content, std::vector<MacAddress>* macs, std::string* error) {
+    macs->clear();
+    bool end = false;
+    int lineno = 0;
+    for (const auto& raw : Split(content, "\n")) {
+        lineno++;
+        std::string line = Trim(raw);
+        if (line.empty()) continue;
+        if (end) {
+            *error = StringPrintf("line %d: data after %s", lineno, kEnd);
+            return false;
+        }
+        if (line == kEnd) {
+            end = true;
+            continue;
+        }
+
+        auto eq = line.find('=');
+        unsigned int index;
+        if (eq == std::string::npos || !ParseKey(line.substr(0, eq), &index)) {
+            *error = StringPrintf("line %d: expected Intf<n>MacAddress=<mac>", lineno);
+            return false;
+        }
+        if (index != macs->size()) {
+            *error = StringPrintf("line %d: interface %u out of order", lineno, index);
+            return false;
+        }
+
+        MacAddress mac;
+        if (!ParseMac(line.substr(eq + 1), &mac)) {
+            *error = StringPrintf("line %d: malformed address", lineno);
+            return false;
+        }
+        if (std::all_of(mac.begin(), mac.end(), [](uint8_t b) { return b == 0; })) {
+            *error = StringPrintf("line %d: zero address", lineno);
+            return false;
+        }
+        // Also catches the broadcast address.
+        if (mac[0] & 0x01) {
+            *error = StringPrintf("line %d: multicast address", lineno);
+            return false;
+        }
+        if (std::find(macs->begin(), macs->end(), mac) != macs->end()) {
+            *error = StringPrintf("line %d: duplicate address", lineno);
+            return false;
+        }
+        macs->push_back(mac);
+    }
+    if (macs->empty()) {
+        *error = "no addresses";
+        return false;
+    }
+    if (!end) {
+        *error = StringPrintf("missing %s, file is truncated", kEnd);
+        return false;
+    }
+    return true;
+}
+
+std::string EncodeCache(const std::string& payload) {
+    return StringPrintf("%s %u %08x\n", kCacheMagic, kCacheVersion, Crc32(payload)) + payload;
+}
+
+bool DecodeCache(const std::string& cache, std::string* payload, std::string* error) {
+    auto newline = cache.find('\n');
+    if (newline == std::string::npos) {
+        *error = "no header";
+        return false;
+    }
+    auto header = Split(cache.substr(0, newline), " ");
+    unsigned int version;
+    uint32_t crc;
+    if (header.size() != 3 || header[0] != kCacheMagic || !ParseUint(header[1], &version) ||
+        !ParseUint("0x" + header[2], &crc)) {
+        *error = "malformed header";
+        return false;
+    }
+    if (version != kCacheVersion) {
+        *error = StringPrintf("version %u, expected %u", version, kCacheVersion);
+        return false;
+    }
+    *payload = cache.substr(newline + 1);
+    if (Crc32(*payload) != crc) {
+        *error = "checksum mismatch";
+        return false;
+    }
+    std::vector<MacAddress> macs;
+    return ParseMacFile(*payload, &macs, error);
+}
+
+Action Decide(const std::optional<std::string>& cache, const std::optional<std::string>& persist,
+              std::string* reason) {
+    std::string payload, cacheError, persistError;
+    bool cacheValid = cache && DecodeCache(*cache, &payload, &cacheError);
+    std::vector<MacAddress> macs;
+    bool persistValid = persist && ParseMacFile(*persist, &macs, &persistError);
+
+    if (cacheValid) {
+        if (persistValid && *persist == payload) {
+            *reason = "cache matches";
+            return Action::kHit;
+        }
+        if (!persistValid) {
+            *reason = persist ? "persist file invalid: " + persistError : "persist file missing";
+            return Action::kRestore;
+        }
+        // Both valid but different: the persist file was provisioned
+        // again, NV decides.
+        *reason = "cache and persist file disagree";
+        return Action::kMiss;
+    }
+    if (persistValid) {
+        *reason = cache ? "cache invalid: " + cacheError : "no cache";
+        return Action::kAdopt;
+    }
+    *reason = std::string(cache ? "cache invalid: " + cacheError : "no cache") + ", " +
+              (persist ? "persist file invalid: " + persistError : "persist file missing");
+    return Action::kMiss;
+}
+
+const char* ActionName(Action action) {
+    switch (action) {
+        case Action::kHit: return "hit";
+        case Action::kRestore: return "restore";
+        case Action::kAdopt: return "adopt";
+        case Action::kMiss: return "miss";
+    }
+    return "unknown";
+}
+
+}  // namespace wlanmac
+}  // namespace vendor
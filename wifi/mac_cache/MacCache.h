@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vendor {
+namespace wlanmac {
+
+using MacAddress = std::array<uint8_t, 6>;
+
+// Parses a qca_cld wlan_mac.bin:
+//   Intf0MacAddress=00AABBCCDDEE
+//   Intf1MacAddress=...
+//   END
+// Interfaces must be numbered from 0 without gaps and every address must
+// be a unique, unicast, non-zero one. The END line is required so that a
+// file cut short by a crash is not taken as valid.
+bool ParseMacFile(const std::string& content, std::vector<MacAddress>* macs, std::string* error);
+
+// The cache is the validated wlan_mac.bin behind a header line carrying
+// a format version and the CRC32 of the payload.
+std::string EncodeCache(const std::string& payload);
+bool DecodeCache(const std::string& cache, std::string* payload, std::string* error);
+
+enum class Action {
+    // Cache and persist file agree, nothing to do.
+    kHit,
+    // Persist file is gone or damaged, rewrite it from the cache.
+    kRestore,
+    // No usable cache but a valid persist file from an earlier NV
+    // query, store it in the cache.
+    kAdopt,
+    // Nothing usable, or cache and persist disagree: query NV.
+    kMiss,
+};
+
+// Decides what to do with the cache and persist file contents, nullopt
+// meaning the file could not be read.
+Action Decide(const std::optional<std::string>& cache, const std::optional<std::string>& persist,
+              std::string* reason);
+
+const char* ActionName(Action action);
+
+}  // namespace wlanmac
+}  // namespace vendor
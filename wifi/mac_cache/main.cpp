@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2022 The LineageOS Project
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define LOG_TAG "vendor.wlan_mac_cache"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#ifdef __ANDROID__
+#include <android-base/properties.h>
+#endif
+
+#include "MacCache.h"
+
+using android::base::ReadFileToString;
+using android::base::WriteStringToFile;
+using vendor::wlanmac::Action;
+using vendor::wlanmac::ActionName;
+using vendor::wlanmac::Decide;
+using vendor::wlanmac::DecodeCache;
+using vendor::wlanmac::EncodeCache;
+using vendor::wlanmac::MacAddress;
+using vendor::wlanmac::ParseMacFile;
+
+namespace {
+
+constexpr char kDefaultCache[] = "/data/vendor/mac_addr/wlan_mac.cache";
+// Read by the WLAN driver through /vendor/firmware/wlan/qca_cld/wlan_mac.bin.
+constexpr char kDefaultPersist[] = "/mnt/vendor/persist/wlan_mac.bin";
+// init starts nv_mac when this reads "miss", see init.xiaomi.rc.
+constexpr char kStateProp[] = "vendor.wlan.mac_cache";
+
+std::optional<std::string> ReadOptional(const std::string& path) {
+    std::string content;
+    if (!ReadFileToString(path, &content)) return std::nullopt;
+    return content;
+}
+
+bool WriteCache(const std::string& payload, const std::string& path) {
+    std::string tmp = path + ".tmp";
+    if (!WriteStringToFile(EncodeCache(payload), tmp) || rename(tmp.c_str(), path.c_str())) {
+        PLOG(ERROR) << "Failed to write " << path;
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void SetState(const char* state) {
+#ifdef __ANDROID__
+    android::base::SetProperty(kStateProp, state);
+#else
+    printf("%s=%s\n", kStateProp, state);
+#endif
+}
+
+// Runs before the WLAN driver loads: makes sure the persist file holds
+// the cached addresses, or asks for an NV query.
+int Check(const std::string& cachePath, const std::string& persistPath) {
+    std::string reason;
+    Action action = Decide(ReadOptional(cachePath), ReadOptional(persistPath), &reason);
+    LOG(INFO) << ActionName(action) << ": " << reason;
+
+    std::string payload, error;
+    switch (action) {
+        case Action::kHit:
+            SetState("hit");
+            return 0;
+        case Action::kRestore:
+            // Written in place, a torn write lacks END and is caught on
+            // the next boot.
+            if (DecodeCache(*ReadOptional(cachePath), &payload, &error) &&
+                WriteStringToFile(payload, persistPath)) {
+                SetState("restored");
+                return 0;
+            }
+            PLOG(ERROR) << "Failed to restore " << persistPath;
+            SetState("miss");
+            return 1;
+        case Action::kAdopt:
+            // The persist file is valid either way, a failed cache write
+            // only costs an adopt on the next boot.
+            WriteCache(*ReadOptional(persistPath), cachePath);
+            SetState("adopted");
+            return 0;
+        case Action::kMiss:
+            SetState("miss");
+            return 0;
+    }
+    return 1;
+}
+
+// Runs after nv_mac: caches what it provisioned.
+int Store(const std::string& cachePath, const std::string& persistPath) {
+    std::vector<MacAddress> macs;
+    std::string error;
+    auto persist = ReadOptional(persistPath);
+    if (!persist || !ParseMacFile(*persist, &macs, &error)) {
+        LOG(ERROR) << "nv_mac left no valid " << persistPath << ": "
+                   << (persist ? error : "missing");
+        SetState("invalid");
+        return 1;
+    }
+    if (!WriteCache(*persist, cachePath)) {
+        SetState("invalid");
+        return 1;
+    }
+    LOG(INFO) << "Cached " << macs.size() << " addresses";
+    SetState("stored");
+    return 0;
+}
+
+void Usage(const char* name) {
+    fprintf(stderr, "usage: %s [--cache FILE] [--persist FILE] [--store]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string cachePath = kDefaultCache;
+    std::string persistPath = kDefaultPersist;
+    bool store = false;
+
+    static const option options[] = {
+            {"cache", required_argument, nullptr, 'c'},
+            {"persist", required_argument, nullptr, 'p'},
+            {"store", no_argument, nullptr, 's'},
+            {nullptr, 0, nullptr, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:p:s", options, nullptr)) != -1) {
+        switch (opt) {
+            case 'c': cachePath = optarg; break;
+            case 'p': persistPath = optarg; break;
+            case 's': store = true; break;
+            default: Usage(argv[0]); return 1;
+        }
+    }
+
+    return store ? Store(cachePath, persistPath) : Check(cachePath, persistPath);
+}
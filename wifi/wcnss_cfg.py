@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2022 The LineageOS Project
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+
+"""Lint WCNSS_qcom_cfg.ini against a key schema and generate profiles.
+
+  wcnss_cfg.py lint [--schema FILE] [--werror] INI
+  wcnss_cfg.py generate [--schema FILE] --profile FILE -o OUT INI
+
+A profile is a plain key=value file. Every key it sets must be flagged
+"profile" in the schema, so generated inis only differ from the base in
+the power/latency/throughput knobs.
+"""
+
+import argparse
+import os
+import sys
+
+END_MARKER = 'END'
+MAC_DIGITS = set('0123456789abcdefABCDEF')
+
+
+class Key:
+    def __init__(self, name, kind, lo=None, hi=None, flags=()):
+        self.name = name
+        self.kind = kind
+        self.lo = lo
+        self.hi = hi
+        self.profile = 'profile' in flags
+        self.deprecated = 'deprecated' in flags
+
+    def check(self, value):
+        """Returns an error string, or None if value is acceptable."""
+        if self.kind == 'mac':
+            if len(value) != 12 or not set(value) <= MAC_DIGITS:
+                return 'expected 12 hex digits'
+            return None
+        if self.kind == 'iface':
+            if not value or not value.isalnum():
+                return 'expected an interface name'
+            return None
+        try:
+            number = int(value, 16 if self.kind == 'hex' else 10)
+        except ValueError:
+            return 'expected %s value' % self.kind
+        if self.kind == 'bool':
+            lo, hi = 0, 1
+        else:
+            lo, hi = self.lo, self.hi
+        if lo is not None and not lo <= number <= hi:
+            return 'out of range [%s, %s]' % (lo, hi)
+        return None
+
+
+def parse_int(text):
+    return int(text, 16) if text.lower().startswith('0x') else int(text)
+
+
+def load_schema(path):
+    schema = {}
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            name, kind, rest = fields[0], fields[1], fields[2:]
+            lo = hi = None
+            if kind in ('int', 'hex'):
+                lo, hi = parse_int(rest[0]), parse_int(rest[1])
+                rest = rest[2:]
+            if name in schema:
+                sys.exit('%s:%d: duplicate schema key %s' % (path, lineno, name))
+            schema[name] = Key(name, kind, lo, hi, rest)
+    return schema
+
+
+def parse_ini(path):
+    """Returns (entries, end_lineno, lines).
+
+    entries is a list of (lineno, key, value, raw) for every assignment,
+    including the ones after the END marker.
+    """
+    with open(path, 'r') as f:
+        lines = f.read().splitlines()
+
+    entries = []
+    end_lineno = None
+    for lineno, line in enumerate(lines, 1):
+        stripped = line.strip()
+        if not stripped or stripped.startswith('#'):
+            continue
+        if stripped == END_MARKER:
+            if end_lineno is None:
+                end_lineno = lineno
+            continue
+        if '=' not in stripped:
+            entries.append((lineno, None, None, line))
+            continue
+        key, value = stripped.split('=', 1)
+        entries.append((lineno, key.strip(), value.strip(), line))
+    return entries, end_lineno, lines
+
+
+def lint(path, schema):
+    """Returns (errors, warnings) as lists of printable strings."""
+    errors = []
+    warnings = []
+    entries, end_lineno, _ = parse_ini(path)
+
+    if end_lineno is None:
+        errors.append('%s: missing %s marker' % (path, END_MARKER))
+
+    seen = {}
+    for lineno, key, value, raw in entries:
+        where = '%s:%d' % (path, lineno)
+        if key is None:
+            errors.append('%s: not a key=value line: %s' % (where, raw.strip()))
+            continue
+        if end_lineno is not None and lineno > end_lineno:
+            warnings.append('%s: dead key %s after %s marker' % (where, key, END_MARKER))
+            continue
+        if key in seen:
+            errors.append('%s: duplicate key %s (first set on line %d)' %
+                          (where, key, seen[key]))
+        seen[key] = lineno
+
+        spec = schema.get(key)
+        if spec is None:
+            errors.append('%s: unknown key %s' % (where, key))
+            continue
+        if spec.deprecated:
+            warnings.append('%s: dead key %s is no longer parsed by the driver' % (where, key))
+        problem = spec.check(value)
+        if problem:
+            errors.append('%s: %s=%s: %s' % (where, key, value, problem))
+        if raw.strip() != '%s=%s' % (key, value):
+            warnings.append('%s: whitespace around = in %s' % (where, key))
+
+    return errors, warnings
+
+
+def load_profile(path, schema):
+    overrides = {}
+    entries, _, _ = parse_ini(path)
+    for lineno, key, value, raw in entries:
+        where = '%s:%d' % (path, lineno)
+        if key is None:
+            sys.exit('%s: not a key=value line: %s' % (where, raw.strip()))
+        spec = schema.get(key)
+        if spec is None:
+            sys.exit('%s: unknown key %s' % (where, key))
+        if not spec.profile:
+            sys.exit('%s: %s is not a profile knob' % (where, key))
+        problem = spec.check(value)
+        if problem:
+            sys.exit('%s: %s=%s: %s' % (where, key, value, problem))
+        if key in overrides:
+            sys.exit('%s: duplicate key %s' % (where, key))
+        overrides[key] = value
+    return overrides
+
+
+def generate(path, profile_path, schema):
+    entries, end_lineno, lines = parse_ini(path)
+    overrides = load_profile(profile_path, schema)
+    pending = dict(overrides)
+
+    out = list(lines)
+    for lineno, key, _, _ in entries:
+        if key in pending and (end_lineno is None or lineno < end_lineno):
+            out[lineno - 1] = '%s=%s' % (key, pending.pop(key))
+
+    added = ['%s=%s' % (key, value) for key, value in pending.items()]
+    if added:
+        index = end_lineno - 1 if end_lineno is not None else len(out)
+        added = ['# Added by profile %s' %
+                 os.path.splitext(os.path.basename(profile_path))[0]] + added + ['']
+        out[index:index] = added
+
+    header = ['# Generated by wcnss_cfg.py from %s and %s, do not edit.' %
+              (os.path.basename(path), os.path.basename(profile_path))]
+    return '\n'.join(header + out) + '\n'
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--schema', default=os.path.join(here, 'WCNSS_qcom_cfg.schema'))
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    lint_parser = sub.add_parser('lint')
+    lint_parser.add_argument('--werror', action='store_true')
+    lint_parser.add_argument('ini')
+
+    gen_parser = sub.add_parser('generate')
+    gen_parser.add_argument('--profile', required=True)
+    gen_parser.add_argument('-o', '--output', required=True)
+    gen_parser.add_argument('ini')
+
+    args = parser.parse_args()
+    schema = load_schema(args.schema)
+
+    errors, warnings = lint(args.ini, schema)
+    for message in warnings:
+        print('warning: ' + message, file=sys.stderr)
+    for message in errors:
+        print('error: ' + message, file=sys.stderr)
+    if errors or (args.command == 'lint' and args.werror and warnings):
+        return 1
+
+    if args.command == 'generate':
+        with open(args.output, 'w') as f:
+            f.write(generate(args.ini, args.profile, schema))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())